@@ -26,8 +26,13 @@
    COLOR SETTINGS
  *====================*/
 
-/*Color depth: 1 (I1), 8 (L8), 16 (RGB565), 24 (RGB888), 32 (XRGB8888)*/
+/*Color depth: 1 (I1), 8 (L8), 16 (RGB565), 24 (RGB888), 32 (XRGB8888)
+ *16 is picked in Kconfig for RGB565 panels, the JPEG PP, PPE and LCDC follow it*/
+#if defined(CONFIG_LVGL_COLOR_DEPTH_16) && CONFIG_LVGL_COLOR_DEPTH_16
+#define LV_COLOR_DEPTH 16
+#else
 #define LV_COLOR_DEPTH 32
+#endif
 
 #define LV_COLOR_16_SWAP 0
 
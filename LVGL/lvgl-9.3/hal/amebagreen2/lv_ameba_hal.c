@@ -14,11 +14,13 @@
  */
 
 #include "lv_ameba_jpeg.h"
+#include "lv_ameba_img_prefetch.h"
 #include "lv_draw_ppe.h"
 #include "lv_ameba_hal.h"
 
 void lv_ameba_hal_init(void)
 {
     lv_ameba_jpeg_init();
+    lv_ameba_img_prefetch_init();
     lv_draw_ppe_init();
 }
@@ -0,0 +1,564 @@
+/*
+ * Copyright (c) 2026 Realtek Semiconductor Corp.
+ * All rights reserved.
+ *
+ * Licensed under the Realtek License, Version 1.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License from Realtek
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "lv_ameba_img_cache.h"
+#include "lv_ameba_jpeg.h"
+
+#include "src/draw/lv_image_decoder_private.h"
+#include "src/misc/lv_ll.h"
+#include "src/misc/lv_log.h"
+#include "src/osal/lv_os.h"
+#include "src/stdlib/lv_mem.h"
+#include "src/stdlib/lv_string.h"
+
+#define CACHE_DEBUG 0
+#define DECODER_NAME "AMEBA_CACHE"
+
+/* Hash buckets for key and buffer lookups, power of two */
+#define CACHE_BUCKETS 32
+
+/* One decoded image, the list is kept in LRU order with the most recent at the head */
+typedef struct _img_cache_entry_t {
+    lv_ameba_img_cache_key_t key;
+    char *path;                 /**< Owned copy of the path for file sources */
+    lv_draw_buf_t *buf;
+    size_t size;
+    uint32_t hash;              /**< Of `key` */
+    struct _img_cache_entry_t *key_next;    /**< Next in the bucket of `hash` */
+    struct _img_cache_entry_t *buf_next;    /**< Next in the bucket of `buf` */
+    uint16_t ref_cnt;           /**< Users currently drawing from `buf` */
+    uint16_t pin_cnt;           /**< Kept resident on request of the application */
+} img_cache_entry_t;
+
+typedef struct {
+    lv_ll_t entries;
+    img_cache_entry_t *key_buckets[CACHE_BUCKETS];
+    img_cache_entry_t *buf_buckets[CACHE_BUCKETS];
+    uint32_t count;
+    lv_mutex_t lock;
+    lv_image_decoder_t *decoder;
+    size_t budget;
+    size_t used;
+    uint32_t hits;
+    uint32_t misses;
+    uint32_t evictions;
+    bool inited;
+} img_cache_t;
+
+static img_cache_t g_img_cache;
+
+static bool key_same_src(const lv_ameba_img_cache_key_t *a, const lv_ameba_img_cache_key_t *b)
+{
+    if (a->src_type != b->src_type) {
+        return false;
+    }
+
+    if (a->src_type == LV_IMAGE_SRC_FILE) {
+        return lv_strcmp(a->src, b->src) == 0;
+    }
+
+    return a->src == b->src && a->data_size == b->data_size &&
+           a->header.w == b->header.w && a->header.h == b->header.h &&
+           a->header.cf == b->header.cf && a->header.flags == b->header.flags &&
+           a->header.stride == b->header.stride;
+}
+
+bool lv_ameba_img_cache_key_equal(const lv_ameba_img_cache_key_t *a, const lv_ameba_img_cache_key_t *b)
+{
+    return a->out_w == b->out_w && a->out_h == b->out_h &&
+           a->crop_x == b->crop_x && a->crop_y == b->crop_y &&
+           a->crop_w == b->crop_w && a->crop_h == b->crop_h &&
+           key_same_src(a, b);
+}
+
+static uint32_t hash_step(uint32_t hash, uint32_t v)
+{
+    return (hash ^ v) * 16777619u;
+}
+
+/* FNV-1a over what lv_ameba_img_cache_key_equal compares, computed before taking the lock */
+static uint32_t key_hash(const lv_ameba_img_cache_key_t *key)
+{
+    uint32_t hash = 2166136261u;
+
+    if (key->src_type == LV_IMAGE_SRC_FILE) {
+        for (const char *c = key->src; *c; c++) {
+            hash = hash_step(hash, (uint8_t)*c);
+        }
+    } else {
+        hash = hash_step(hash, (uint32_t)(uintptr_t)key->src);
+        hash = hash_step(hash, key->data_size);
+    }
+
+    hash = hash_step(hash, key->out_w | (uint32_t)key->out_h << 16);
+    hash = hash_step(hash, key->crop_x | (uint32_t)key->crop_y << 16);
+    hash = hash_step(hash, key->crop_w | (uint32_t)key->crop_h << 16);
+
+    return hash;
+}
+
+static uint32_t buf_bucket(const lv_draw_buf_t *buf)
+{
+    return ((uintptr_t)buf >> 4) & (CACHE_BUCKETS - 1);
+}
+
+static img_cache_entry_t *entry_find(const lv_ameba_img_cache_key_t *key, uint32_t hash)
+{
+    img_cache_entry_t *entry = g_img_cache.key_buckets[hash & (CACHE_BUCKETS - 1)];
+
+    for (; entry; entry = entry->key_next) {
+        if (entry->hash == hash && lv_ameba_img_cache_key_equal(&entry->key, key)) {
+            return entry;
+        }
+    }
+
+    return NULL;
+}
+
+static img_cache_entry_t *entry_find_buf(const lv_draw_buf_t *buf)
+{
+    img_cache_entry_t *entry = g_img_cache.buf_buckets[buf_bucket(buf)];
+
+    for (; entry; entry = entry->buf_next) {
+        if (entry->buf == buf) {
+            return entry;
+        }
+    }
+
+    return NULL;
+}
+
+static void entry_unlink(img_cache_entry_t **bucket, img_cache_entry_t *entry, bool by_key)
+{
+    for (; *bucket; bucket = by_key ? &(*bucket)->key_next : &(*bucket)->buf_next) {
+        if (*bucket == entry) {
+            *bucket = by_key ? entry->key_next : entry->buf_next;
+            return;
+        }
+    }
+}
+
+static void entry_free(img_cache_entry_t *entry)
+{
+    entry_unlink(&g_img_cache.key_buckets[entry->hash & (CACHE_BUCKETS - 1)], entry, true);
+    entry_unlink(&g_img_cache.buf_buckets[buf_bucket(entry->buf)], entry, false);
+    g_img_cache.count--;
+    g_img_cache.used -= entry->size;
+    lv_ll_remove(&g_img_cache.entries, entry);
+    lv_draw_buf_destroy(entry->buf);
+    if (entry->path) {
+        lv_free(entry->path);
+    }
+    lv_free(entry);
+}
+
+/* Evict unused entries from the LRU end until `budget` bytes are in use, returns the bytes freed */
+static size_t evict_to(size_t budget)
+{
+    size_t freed = 0;
+    img_cache_entry_t *entry = lv_ll_get_tail(&g_img_cache.entries);
+
+    while (entry && g_img_cache.used > budget) {
+        img_cache_entry_t *prev = lv_ll_get_prev(&g_img_cache.entries, entry);
+        if (entry->ref_cnt == 0 && entry->pin_cnt == 0) {
+#if CACHE_DEBUG
+            printf("img cache evict %p (%u bytes)\n", entry->key.src, (unsigned)entry->size);
+#endif
+            freed += entry->size;
+            g_img_cache.evictions++;
+            entry_free(entry);
+        }
+        entry = prev;
+    }
+
+    return freed;
+}
+
+/* Only undecoded sources can be in the cache, images already in LVGL's formats are drawn in place */
+static bool src_may_be_cached(const void *src, lv_image_src_t src_type)
+{
+    if (src_type == LV_IMAGE_SRC_VARIABLE) {
+        const lv_image_dsc_t *img_dsc = src;
+        return img_dsc->header.cf == LV_COLOR_FORMAT_RAW || img_dsc->header.cf == LV_COLOR_FORMAT_RAW_ALPHA ||
+               img_dsc->header.cf == LV_COLOR_FORMAT_UNKNOWN;
+    }
+
+    return src_type == LV_IMAGE_SRC_FILE;
+}
+
+static lv_result_t decoder_info_cb(lv_image_decoder_t *decoder, lv_image_decoder_dsc_t *dsc, lv_image_header_t *header)
+{
+    LV_UNUSED(decoder);
+    lv_ameba_img_cache_key_t key;
+    lv_result_t res = LV_RESULT_INVALID;
+
+    /* Runs for every image LVGL draws, so answer most of them without the lock */
+    if (g_img_cache.count == 0 || !src_may_be_cached(dsc->src, dsc->src_type)) {
+        return LV_RESULT_INVALID;
+    }
+
+    lv_ameba_img_cache_key_init(&key, dsc->src);
+    uint32_t hash = key_hash(&key);
+
+    lv_mutex_lock(&g_img_cache.lock);
+    img_cache_entry_t *entry = entry_find(&key, hash);
+    if (entry) {
+        *header = entry->buf->header;
+        header->flags = 0;
+        res = LV_RESULT_OK;
+    }
+    lv_mutex_unlock(&g_img_cache.lock);
+
+    return res;
+}
+
+/*
+ * Evicted since info_cb, while LVGL's header cache keeps sending the source here.
+ * Decode it again with the decoder that takes it and serve the result from here,
+ * so `dsc` stays ours and its close comes back to decoder_close_cb.
+ */
+static lv_draw_buf_t *decode_again(lv_image_decoder_t *self, lv_image_decoder_dsc_t *dsc,
+                                   const lv_ameba_img_cache_key_t *key)
+{
+    lv_image_decoder_dsc_t sub;
+    lv_image_decoder_t *next;
+    lv_draw_buf_t *buf = NULL;
+
+    for (next = lv_image_decoder_get_next(NULL); next; next = lv_image_decoder_get_next(next)) {
+        if (next == self || next->info_cb == NULL || next->open_cb == NULL) {
+            continue;
+        }
+
+        lv_memzero(&sub, sizeof(sub));
+        sub.decoder = next;
+        sub.args = dsc->args;
+        sub.args.no_cache = true;   /* Cached here, not in LVGL's image cache */
+        sub.src = dsc->src;
+        sub.src_type = dsc->src_type;
+        sub.file = dsc->file;
+        sub.cache = dsc->cache;
+        if (next->info_cb(next, &sub, &sub.header) == LV_RESULT_OK) {
+            break;
+        }
+    }
+
+    if (next == NULL || next->open_cb(next, &sub) != LV_RESULT_OK) {
+        return NULL;
+    }
+
+    /* JPEG_RTK puts what it decodes in the cache itself */
+    buf = lv_ameba_img_cache_acquire(key);
+    if (buf == NULL && sub.decoded) {
+        buf = lv_draw_buf_dup(sub.decoded);
+        if (buf) {
+            /* Over the budget it stays owned by `dsc`, decoder_close_cb destroys it */
+            lv_ameba_img_cache_add(key, buf, true);
+        }
+    }
+
+    if (next->close_cb) {
+        next->close_cb(next, &sub);
+    }
+
+    return buf;
+}
+
+static lv_result_t decoder_open_cb(lv_image_decoder_t *decoder, lv_image_decoder_dsc_t *dsc)
+{
+    lv_ameba_img_cache_key_t key;
+
+    lv_ameba_img_cache_key_init(&key, dsc->src);
+    lv_draw_buf_t *buf = lv_ameba_img_cache_acquire(&key);
+    if (buf == NULL) {
+        buf = decode_again(decoder, dsc, &key);
+    }
+
+    if (buf == NULL) {
+        return LV_RESULT_INVALID;
+    }
+
+    dsc->decoded = buf;
+
+    return LV_RESULT_OK;
+}
+
+static void decoder_close_cb(lv_image_decoder_t *decoder, lv_image_decoder_dsc_t *dsc)
+{
+    LV_UNUSED(decoder);
+
+    if (dsc->decoded && !lv_ameba_img_cache_release(dsc->decoded)) {
+        lv_draw_buf_destroy((lv_draw_buf_t *)dsc->decoded);
+    }
+}
+
+void lv_ameba_img_cache_init(void)
+{
+    if (g_img_cache.inited) {
+        return;
+    }
+
+    lv_ll_init(&g_img_cache.entries, sizeof(img_cache_entry_t));
+    lv_mutex_init(&g_img_cache.lock);
+    g_img_cache.budget = LV_AMEBA_IMG_CACHE_SIZE;
+
+    g_img_cache.decoder = lv_image_decoder_create();
+    lv_image_decoder_set_info_cb(g_img_cache.decoder, decoder_info_cb);
+    lv_image_decoder_set_open_cb(g_img_cache.decoder, decoder_open_cb);
+    lv_image_decoder_set_close_cb(g_img_cache.decoder, decoder_close_cb);
+    g_img_cache.decoder->name = DECODER_NAME;
+
+    g_img_cache.inited = true;
+}
+
+void lv_ameba_img_cache_deinit(void)
+{
+    if (!g_img_cache.inited) {
+        return;
+    }
+
+    lv_mutex_lock(&g_img_cache.lock);
+    evict_to(0);
+    if (g_img_cache.used) {
+        LV_LOG_WARN("%u bytes of decoded images still in use", (unsigned)g_img_cache.used);
+    }
+    lv_mutex_unlock(&g_img_cache.lock);
+    lv_image_decoder_delete(g_img_cache.decoder);
+    lv_mutex_delete(&g_img_cache.lock);
+    g_img_cache.inited = false;
+}
+
+void lv_ameba_img_cache_set_budget(size_t bytes)
+{
+    lv_mutex_lock(&g_img_cache.lock);
+    g_img_cache.budget = bytes;
+    evict_to(bytes);
+    lv_mutex_unlock(&g_img_cache.lock);
+}
+
+void lv_ameba_img_cache_key_init(lv_ameba_img_cache_key_t *key, const void *src)
+{
+    lv_memzero(key, sizeof(*key));
+    key->src_type = lv_image_src_get_type(src);
+
+    if (key->src_type == LV_IMAGE_SRC_FILE) {
+        key->src = src;
+    } else if (key->src_type == LV_IMAGE_SRC_VARIABLE) {
+        const lv_image_dsc_t *img_dsc = src;
+
+        key->src = img_dsc->data;
+        key->data_size = img_dsc->data_size;
+        key->header = img_dsc->header;
+        if (img_dsc->header.cf == LV_COLOR_FORMAT_RAW && (img_dsc->header.flags & LV_AMEBA_JPEG_FLAG_SCALED)) {
+            const lv_ameba_jpeg_src_t *jpeg_src = src;
+            if (img_dsc->data == NULL) {
+                key->src_type = LV_IMAGE_SRC_FILE;
+                key->src = jpeg_src->path;
+                key->data_size = 0;
+                lv_memzero(&key->header, sizeof(key->header));
+            }
+            key->out_w = img_dsc->header.w;
+            key->out_h = img_dsc->header.h;
+            key->crop_x = jpeg_src->crop_x;
+            key->crop_y = jpeg_src->crop_y;
+            key->crop_w = jpeg_src->crop_w;
+            key->crop_h = jpeg_src->crop_h;
+        }
+    } else {
+        key->src = src;
+    }
+}
+
+lv_draw_buf_t *lv_ameba_img_cache_acquire(const lv_ameba_img_cache_key_t *key)
+{
+    lv_draw_buf_t *buf = NULL;
+    uint32_t hash = key_hash(key);
+
+    lv_mutex_lock(&g_img_cache.lock);
+    img_cache_entry_t *entry = entry_find(key, hash);
+    if (entry) {
+        entry->ref_cnt++;
+        lv_ll_move_before(&g_img_cache.entries, entry, lv_ll_get_head(&g_img_cache.entries));
+        buf = entry->buf;
+        g_img_cache.hits++;
+    } else {
+        g_img_cache.misses++;
+    }
+    lv_mutex_unlock(&g_img_cache.lock);
+
+    return buf;
+}
+
+bool lv_ameba_img_cache_contains(const lv_ameba_img_cache_key_t *key)
+{
+    uint32_t hash = key_hash(key);
+
+    lv_mutex_lock(&g_img_cache.lock);
+    bool found = entry_find(key, hash) != NULL;
+    lv_mutex_unlock(&g_img_cache.lock);
+
+    return found;
+}
+
+lv_result_t lv_ameba_img_cache_add(const lv_ameba_img_cache_key_t *key, lv_draw_buf_t *buf, bool acquire)
+{
+    size_t size = buf->data_size;
+    lv_result_t res = LV_RESULT_INVALID;
+    uint32_t hash = key_hash(key);
+
+    lv_mutex_lock(&g_img_cache.lock);
+
+    /* Someone else decoded the same image meanwhile, keep theirs */
+    if (entry_find(key, hash)) {
+        goto end;
+    }
+
+    if (size > g_img_cache.budget) {
+        goto end;
+    }
+
+    evict_to(g_img_cache.budget - size);
+    if (g_img_cache.used + size > g_img_cache.budget) {
+        goto end;
+    }
+
+    img_cache_entry_t *entry = lv_ll_ins_head(&g_img_cache.entries);
+    if (entry == NULL) {
+        goto end;
+    }
+
+    lv_memzero(entry, sizeof(*entry));
+    entry->key = *key;
+    if (key->src_type == LV_IMAGE_SRC_FILE) {
+        entry->path = lv_strdup(key->src);
+        if (entry->path == NULL) {
+            lv_ll_remove(&g_img_cache.entries, entry);
+            lv_free(entry);
+            goto end;
+        }
+        entry->key.src = entry->path;
+    }
+    entry->buf = buf;
+    entry->size = size;
+    entry->hash = hash;
+    entry->ref_cnt = acquire ? 1 : 0;
+    entry->key_next = g_img_cache.key_buckets[hash & (CACHE_BUCKETS - 1)];
+    g_img_cache.key_buckets[hash & (CACHE_BUCKETS - 1)] = entry;
+    entry->buf_next = g_img_cache.buf_buckets[buf_bucket(buf)];
+    g_img_cache.buf_buckets[buf_bucket(buf)] = entry;
+    g_img_cache.count++;
+    g_img_cache.used += size;
+    res = LV_RESULT_OK;
+
+end:
+    lv_mutex_unlock(&g_img_cache.lock);
+    return res;
+}
+
+bool lv_ameba_img_cache_release(const lv_draw_buf_t *buf)
+{
+    bool cached = false;
+
+    lv_mutex_lock(&g_img_cache.lock);
+    img_cache_entry_t *entry = entry_find_buf(buf);
+    if (entry) {
+        if (entry->ref_cnt) {
+            entry->ref_cnt--;
+        }
+        cached = true;
+    }
+    /* Pinned or in-use entries may have held the cache above the budget */
+    evict_to(g_img_cache.budget);
+    lv_mutex_unlock(&g_img_cache.lock);
+
+    return cached;
+}
+
+lv_result_t lv_ameba_img_cache_pin(const void *src, bool pin)
+{
+    lv_ameba_img_cache_key_t key;
+    lv_result_t res = LV_RESULT_INVALID;
+    img_cache_entry_t *entry;
+
+    lv_ameba_img_cache_key_init(&key, src);
+
+    lv_mutex_lock(&g_img_cache.lock);
+    LV_LL_READ(&g_img_cache.entries, entry) {
+        if (!key_same_src(&entry->key, &key)) {
+            continue;
+        }
+        if (pin) {
+            entry->pin_cnt++;
+        } else if (entry->pin_cnt) {
+            entry->pin_cnt--;
+        }
+        res = LV_RESULT_OK;
+    }
+    if (!pin) {
+        evict_to(g_img_cache.budget);
+    }
+    lv_mutex_unlock(&g_img_cache.lock);
+
+    return res;
+}
+
+void lv_ameba_img_cache_drop(const void *src)
+{
+    lv_ameba_img_cache_key_t key;
+
+    lv_ameba_img_cache_key_init(&key, src);
+
+    lv_mutex_lock(&g_img_cache.lock);
+    img_cache_entry_t *entry = lv_ll_get_head(&g_img_cache.entries);
+    while (entry) {
+        img_cache_entry_t *next = lv_ll_get_next(&g_img_cache.entries, entry);
+        if (entry->ref_cnt == 0 && key_same_src(&entry->key, &key)) {
+            entry_free(entry);
+        }
+        entry = next;
+    }
+    lv_mutex_unlock(&g_img_cache.lock);
+}
+
+size_t lv_ameba_img_cache_reclaim(size_t bytes)
+{
+    size_t freed;
+
+    lv_mutex_lock(&g_img_cache.lock);
+    freed = evict_to(g_img_cache.used > bytes ? g_img_cache.used - bytes : 0);
+    lv_mutex_unlock(&g_img_cache.lock);
+
+    return freed;
+}
+
+void lv_ameba_img_cache_get_stats(lv_ameba_img_cache_stats_t *stats)
+{
+    img_cache_entry_t *entry;
+
+    lv_memzero(stats, sizeof(*stats));
+
+    lv_mutex_lock(&g_img_cache.lock);
+    LV_LL_READ(&g_img_cache.entries, entry) {
+        stats->entries++;
+        if (entry->pin_cnt) {
+            stats->pinned++;
+        }
+    }
+    stats->hits = g_img_cache.hits;
+    stats->misses = g_img_cache.misses;
+    stats->evictions = g_img_cache.evictions;
+    stats->used_bytes = g_img_cache.used;
+    stats->budget_bytes = g_img_cache.budget;
+    lv_mutex_unlock(&g_img_cache.lock);
+}
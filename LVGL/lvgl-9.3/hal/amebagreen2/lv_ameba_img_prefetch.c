@@ -0,0 +1,169 @@
+/*
+ * Copyright (c) 2026 Realtek Semiconductor Corp.
+ * All rights reserved.
+ *
+ * Licensed under the Realtek License, Version 1.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License from Realtek
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "lv_ameba_img_prefetch.h"
+#include "lv_ameba_img_cache.h"
+#include "lv_ameba_jpeg.h"
+
+#include "ameba_soc.h"
+#include "os_wrapper.h"
+
+#include "src/draw/lv_image_decoder_private.h"
+#include "src/osal/lv_os.h"
+
+#define PREFETCH_DEBUG 0
+
+typedef struct {
+    const void *src;
+    lv_ameba_img_prefetch_cb_t cb;
+    void *user_data;
+    uint32_t gen;
+} prefetch_req_t;
+
+static rtos_queue_t prefetch_queue;
+static volatile uint32_t prefetch_gen;
+
+/* Decode with whatever LVGL decoder claims the source, LVGL isn't thread safe so keep it locked */
+static lv_result_t prefetch_decode_sw(const void *src, const lv_ameba_img_cache_key_t *key)
+{
+    lv_image_decoder_dsc_t dsc;
+    lv_result_t res = LV_RESULT_INVALID;
+
+    lv_lock();
+
+    /* The LVGL task may have drawn it while we waited for the lock */
+    if (lv_ameba_img_cache_contains(key)) {
+        lv_unlock();
+        return LV_RESULT_OK;
+    }
+
+    if (lv_image_decoder_open(&dsc, src, NULL) == LV_RESULT_OK) {
+        if (lv_ameba_img_cache_contains(key)) {
+            /* JPEG_RTK decoded it into the cache already, no copy needed */
+            res = LV_RESULT_OK;
+        } else if (dsc.decoded) {
+            lv_draw_buf_t *buf = lv_draw_buf_dup(dsc.decoded);
+            if (buf && lv_ameba_img_cache_add(key, buf, false) == LV_RESULT_OK) {
+                res = LV_RESULT_OK;
+            } else if (buf) {
+                lv_draw_buf_destroy(buf);
+            }
+        }
+        lv_image_decoder_close(&dsc);
+    }
+
+    lv_unlock();
+
+    return res;
+}
+
+static lv_result_t prefetch_one(const void *src)
+{
+    lv_ameba_img_cache_key_t key;
+    lv_draw_buf_t *buf = NULL;
+
+    lv_ameba_img_cache_key_init(&key, src);
+    if (lv_ameba_img_cache_contains(&key)) {
+        return LV_RESULT_OK;
+    }
+
+    /* Native images in memory are drawn in place, nothing to decode */
+    if (key.src_type == LV_IMAGE_SRC_VARIABLE &&
+        ((const lv_image_dsc_t *)src)->header.cf != LV_COLOR_FORMAT_RAW) {
+        return LV_RESULT_OK;
+    }
+
+    if (lv_ameba_jpeg_decode_src(src, &buf) != LV_RESULT_OK) {
+        return prefetch_decode_sw(src, &key);
+    }
+
+    if (lv_ameba_img_cache_add(&key, buf, false) != LV_RESULT_OK) {
+        lv_draw_buf_destroy(buf);
+        /* Not an error if the LVGL task cached the same image meanwhile */
+        return lv_ameba_img_cache_contains(&key) ? LV_RESULT_OK : LV_RESULT_INVALID;
+    }
+
+    return LV_RESULT_OK;
+}
+
+static void prefetch_task(void *param)
+{
+    UNUSED(param);
+    prefetch_req_t req;
+
+    for (;;) {
+        if (rtos_queue_receive(prefetch_queue, &req, RTOS_MAX_TIMEOUT) != RTK_SUCCESS) {
+            continue;
+        }
+
+        if (req.gen != prefetch_gen) {
+            continue;
+        }
+
+#if PREFETCH_DEBUG
+        uint32_t start = rtos_time_get_current_system_time_ms();
+#endif
+        lv_result_t res = prefetch_one(req.src);
+#if PREFETCH_DEBUG
+        printf("prefetch %p %s in %lu ms\n", req.src, res == LV_RESULT_OK ? "done" : "failed",
+               rtos_time_get_current_system_time_ms() - start);
+#endif
+
+        if (req.cb) {
+            req.cb(req.src, res, req.user_data);
+        }
+    }
+}
+
+void lv_ameba_img_prefetch_init(void)
+{
+    if (prefetch_queue) {
+        return;
+    }
+
+    if (rtos_queue_create(&prefetch_queue, LV_AMEBA_IMG_PREFETCH_QUEUE_LEN, sizeof(prefetch_req_t)) != RTK_SUCCESS) {
+        printf("Error: prefetch queue create failed.\n");
+        prefetch_queue = NULL;
+        return;
+    }
+
+    if (rtos_task_create(NULL, "img_prefetch", prefetch_task, NULL,
+                         LV_AMEBA_IMG_PREFETCH_STACK_SIZE, LV_AMEBA_IMG_PREFETCH_PRIO) != RTK_SUCCESS) {
+        printf("Error: prefetch task create failed.\n");
+        rtos_queue_delete(prefetch_queue);
+        prefetch_queue = NULL;
+    }
+}
+
+lv_result_t lv_ameba_img_prefetch(const void *src, lv_ameba_img_prefetch_cb_t cb, void *user_data)
+{
+    prefetch_req_t req;
+
+    if (prefetch_queue == NULL || src == NULL) {
+        return LV_RESULT_INVALID;
+    }
+
+    req.src = src;
+    req.cb = cb;
+    req.user_data = user_data;
+    req.gen = prefetch_gen;
+
+    return rtos_queue_send(prefetch_queue, &req, 0) == RTK_SUCCESS ? LV_RESULT_OK : LV_RESULT_INVALID;
+}
+
+void lv_ameba_img_prefetch_cancel_all(void)
+{
+    prefetch_gen++;
+}
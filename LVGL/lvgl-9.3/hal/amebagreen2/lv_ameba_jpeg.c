@@ -14,6 +14,9 @@
  */
 
 #include "lv_ameba_jpeg.h"
+#include "lv_ameba_jpeg_private.h"
+#include "lv_ameba_img_cache.h"
+#include "lv_fs_romfs.h"
 
 #include "ameba_soc.h"
 #include "os_wrapper.h"
@@ -23,15 +26,49 @@
 #include "src/draw/lv_image_decoder_private.h"
 #include "src/core/lv_global.h"
 #include "src/stdlib/lv_mem.h"
+#include "src/stdlib/lv_string.h"
 #include "src/misc/lv_fs.h"
 #include "src/misc/lv_log.h"
 #include "src/misc/lv_assert.h"
 
+#if LV_USE_LIBJPEG_TURBO
+#include <stdio.h>
+#include <setjmp.h>
+#include "jpeglib.h"
+#include "jerror.h"
+#endif
+
 #define DECODER_NAME "JPEG_RTK"
 
 #define TIME_DEBUG 0
 #define FILE_TIME_DEBUG 0
 
+/*
+ * The decoder and PP are single instance. Decodes may come from the prefetch
+ * and MJPEG tasks too, each brings the instances up and down under this lock.
+ */
+static rtos_mutex_t jpeg_hw_lock;
+
+static lv_ameba_jpeg_stats_t jpeg_stats;
+
+/* What the stream header says, enough to pick a backend without decoding */
+typedef struct {
+    uint16_t w;
+    uint16_t h;
+    uint8_t sof;                /**< Frame marker: 0xC0 baseline, 0xC2 progressive, ... */
+    uint8_t precision;
+    uint8_t comps;
+    uint8_t max_h_samp;         /**< Largest horizontal sampling factor of the components */
+    uint8_t adobe_transform;    /**< From an Adobe APP14 segment, 0xFF if there is none */
+} jpeg_probe_t;
+
+typedef bool (*jpeg_probe_read_t)(void *ctx, uint32_t pos, uint8_t *buf, uint32_t len);
+
+typedef struct {
+    const uint8_t *data;
+    uint32_t size;
+} jpeg_mem_reader_t;
+
 static uint8_t *read_file(const char *filename, uint32_t *size)
 {
 #if FILE_TIME_DEBUG
@@ -98,6 +135,132 @@ failed:
     return data;
 }
 
+static bool probe_read_mem(void *ctx, uint32_t pos, uint8_t *buf, uint32_t len)
+{
+    jpeg_mem_reader_t *mem = ctx;
+
+    if (pos + len > mem->size) {
+        return false;
+    }
+    memcpy(buf, mem->data + pos, len);
+
+    return true;
+}
+
+static bool probe_read_file(void *ctx, uint32_t pos, uint8_t *buf, uint32_t len)
+{
+    uint32_t rn = 0;
+
+    if (lv_fs_seek(ctx, pos, LV_FS_SEEK_SET) != LV_FS_RES_OK) {
+        return false;
+    }
+
+    return lv_fs_read(ctx, buf, len, &rn) == LV_FS_RES_OK && rn == len;
+}
+
+/* Walk the marker segments up to the frame header, skipping their payload */
+static lv_result_t jpeg_probe(jpeg_probe_read_t read, void *ctx, jpeg_probe_t *probe)
+{
+    uint8_t b[12];
+    uint32_t pos = 2;
+
+    memset(probe, 0, sizeof(*probe));
+    probe->adobe_transform = 0xFF;
+
+    if (!read(ctx, 0, b, 3) || b[0] != 0xFF || b[1] != 0xD8 || b[2] != 0xFF) {
+        return LV_RESULT_INVALID;
+    }
+
+    for (;;) {
+        if (!read(ctx, pos, b, 4) || b[0] != 0xFF) {
+            return LV_RESULT_INVALID;
+        }
+
+        /* Fill bytes before a marker */
+        if (b[1] == 0xFF) {
+            pos++;
+            continue;
+        }
+
+        uint8_t marker = b[1];
+        uint32_t len = (b[2] << 8) | b[3];
+
+        if (marker == 0xDA || marker == 0xD9 || len < 2) {
+            return LV_RESULT_INVALID;
+        }
+
+        if (marker >= 0xC0 && marker <= 0xCF && marker != 0xC4 && marker != 0xC8 && marker != 0xCC) {
+            if (!read(ctx, pos + 4, b, 6)) {
+                return LV_RESULT_INVALID;
+            }
+            probe->sof = marker;
+            probe->precision = b[0];
+            probe->h = (b[1] << 8) | b[2];
+            probe->w = (b[3] << 8) | b[4];
+            probe->comps = b[5];
+
+            /* Component id, H/V sampling factors, table of at most 4 components */
+            if (probe->comps == 0 || probe->comps > 4 || !read(ctx, pos + 10, b, probe->comps * 3)) {
+                return LV_RESULT_INVALID;
+            }
+            for (int i = 0; i < probe->comps; i++) {
+                probe->max_h_samp = LV_MAX(probe->max_h_samp, b[i * 3 + 1] >> 4);
+            }
+            return LV_RESULT_OK;
+        }
+
+        if (marker == 0xEE && len >= 14 && read(ctx, pos + 4, b, 12) && memcmp(b, "Adobe", 5) == 0) {
+            probe->adobe_transform = b[11];
+        }
+
+        pos += 2 + len;
+    }
+}
+
+static lv_result_t jpeg_probe_src(const void *src, lv_image_src_t src_type, jpeg_probe_t *probe)
+{
+    const char *path = NULL;
+    jpeg_mem_reader_t mem;
+
+    if (src_type == LV_IMAGE_SRC_FILE) {
+        path = src;
+    } else if (src_type == LV_IMAGE_SRC_VARIABLE) {
+        const lv_image_dsc_t *img_dsc = src;
+        if (img_dsc->header.cf == LV_COLOR_FORMAT_RAW && (img_dsc->header.flags & LV_AMEBA_JPEG_FLAG_SCALED) &&
+            img_dsc->data == NULL) {
+            path = ((const lv_ameba_jpeg_src_t *)src)->path;
+        } else {
+            mem.data = img_dsc->data;
+            mem.size = img_dsc->data_size;
+            return mem.data ? jpeg_probe(probe_read_mem, &mem, probe) : LV_RESULT_INVALID;
+        }
+    } else {
+        return LV_RESULT_INVALID;
+    }
+
+    if (path && lv_fs_romfs_map(path, (const void **)&mem.data, &mem.size) == LV_RESULT_OK) {
+        return jpeg_probe(probe_read_mem, &mem, probe);
+    }
+
+    lv_fs_file_t f;
+    if (path == NULL || lv_fs_open(&f, path, LV_FS_MODE_RD) != LV_FS_RES_OK) {
+        return LV_RESULT_INVALID;
+    }
+    lv_result_t res = jpeg_probe(probe_read_file, &f, probe);
+    lv_fs_close(&f);
+
+    return res;
+}
+
+/* The HW decodes 8-bit baseline YCbCr and grayscale only */
+static bool jpeg_hw_capable(const jpeg_probe_t *probe)
+{
+    return probe->sof == 0xC0 && probe->precision == 8 &&
+           (probe->comps == 1 || probe->comps == 3) &&
+           probe->w >= LV_AMEBA_JPEG_HW_MIN_SIZE && probe->h >= LV_AMEBA_JPEG_HW_MIN_SIZE &&
+           probe->w <= LV_AMEBA_JPEG_HW_MAX_SIZE && probe->h <= LV_AMEBA_JPEG_HW_MAX_SIZE;
+}
+
 static lv_color_format_t trans_format_hw2sw(int format)
 {
     /* Refer to: jpeg_decoder/inc/jpegdecapi.h */
@@ -184,152 +347,244 @@ static int purpose_lv_format(void)
     return LV_RESULT_INVALID;
 }
 
-static lv_result_t decoder_info_cb(lv_image_decoder_t *decoder, lv_image_decoder_dsc_t *dsc, lv_image_header_t *header)
+#define JPEG_ALIGN_UP(x, a)     (((x) + ((a) - 1)) & ~((a) - 1))
+#define JPEG_ALIGN_DOWN(x, a)   ((x) & ~((a) - 1))
+
+/* Requested output of a decode, zero sizes keep the size of the source window */
+typedef struct {
+    uint16_t out_w;
+    uint16_t out_h;
+    uint16_t crop_x;
+    uint16_t crop_y;
+    uint16_t crop_w;
+    uint16_t crop_h;
+} jpeg_out_conf_t;
+
+/* JPEG stream of an image source, `alloc` is set when it was read from a file */
+typedef struct {
+    const uint8_t *data;
+    uint32_t size;
+    uint8_t *alloc;
+} jpeg_stream_t;
+
+static bool is_scaled_src(const void *src, lv_image_src_t src_type)
 {
-    LV_UNUSED(decoder);
-    const void *src = dsc->src;
-    lv_image_src_t src_type = dsc->src_type;
+    if (src_type != LV_IMAGE_SRC_VARIABLE) {
+        return false;
+    }
 
-    JpegDecImageInfo image_info;
-    JpegDecInput jpeg_in;
-    uint8_t *data = NULL;
-    lv_result_t res = LV_RESULT_INVALID;
+    const lv_image_dsc_t *img_dsc = src;
+    return img_dsc->header.magic == LV_IMAGE_HEADER_MAGIC &&
+           img_dsc->header.cf == LV_COLOR_FORMAT_RAW &&
+           (img_dsc->header.flags & LV_AMEBA_JPEG_FLAG_SCALED);
+}
+
+static lv_result_t jpeg_stream_load(const void *src, lv_image_src_t src_type, jpeg_stream_t *stream)
+{
+    memset(stream, 0, sizeof(*stream));
+
+    const char *path = NULL;
 
     if (src_type == LV_IMAGE_SRC_FILE) {
-        uint32_t data_size;
-        data = read_file((const char *)dsc->src, &data_size);
-        if (data == NULL) {
-            LV_LOG_WARN("can't load file %s", dsc->src);
-            return LV_RESULT_INVALID;
+        path = src;
+    } else if (is_scaled_src(src, src_type)) {
+        const lv_ameba_jpeg_src_t *jpeg_src = src;
+        if (jpeg_src->dsc.data == NULL) {
+            path = jpeg_src->path;
+        } else {
+            stream->data = jpeg_src->dsc.data;
+            stream->size = jpeg_src->dsc.data_size;
         }
-
-        memset(&jpeg_in, 0, sizeof(jpeg_in));
-        jpeg_in.streamBuffer.pVirtualAddress = (u32 *)data;
-        jpeg_in.streamBuffer.busAddress = (u32)data;
-        jpeg_in.streamLength = data_size;
-        DCache_Clean((u32)data, data_size);
     } else if (src_type == LV_IMAGE_SRC_VARIABLE) {
         const lv_image_dsc_t *img_dsc = src;
-        if (img_dsc->data_size < 4) {
-            return LV_RESULT_INVALID;
-        }
-        if (img_dsc->data[0] != 0xFF || img_dsc->data[1] != 0xD8 || img_dsc->data[2] != 0xFF) {
-            return LV_RESULT_INVALID;
-        }
-        memset(&jpeg_in, 0, sizeof(jpeg_in));
-        jpeg_in.streamBuffer.pVirtualAddress = (u32 *)img_dsc->data;
-        jpeg_in.streamBuffer.busAddress = (u32)img_dsc->data;
-        jpeg_in.streamLength = img_dsc->data_size;
+        stream->data = img_dsc->data;
+        stream->size = img_dsc->data_size;
     } else {
         return LV_RESULT_INVALID;
     }
-#if TIME_DEBUG
-    uint64_t start, end;
-    uint64_t time_used;
-    start = rtos_time_get_current_system_time_ns();
-#endif
 
-    JpegDecInst jpeg_inst;
+    /* Files on romfs are decoded where they are, others are read into RAM */
+    if (path && lv_fs_romfs_map(path, (const void **)&stream->data, &stream->size) != LV_RESULT_OK) {
+        stream->alloc = read_file(path, &stream->size);
+    }
 
-    if (JpegDecInit(&jpeg_inst) != JPEGDEC_OK) {
-        printf("Error: JpegDecInit Failed.\n");
-        res = LV_RESULT_INVALID;
-        goto end;
+    if (stream->alloc) {
+        stream->data = stream->alloc;
     }
 
-    if (JpegDecGetImageInfo(jpeg_inst, &jpeg_in, &image_info) == JPEGDEC_OK) {
-        header->w = image_info.outputWidth;
-        header->h = image_info.outputHeight;
-        header->cf = trans_format_hw2sw(image_info.outputFormat);
-        res = LV_RESULT_OK;
+    if (stream->data == NULL) {
+        LV_LOG_WARN("can't load jpeg stream");
+        return LV_RESULT_INVALID;
     }
 
-#if TIME_DEBUG
-    end = rtos_time_get_current_system_time_ns();
-    time_used = end - start;
-    printf("Decode info Time used: %lld ns\n", time_used);
-#endif
+    return LV_RESULT_OK;
+}
 
-    if (jpeg_inst) {
-        JpegDecRelease(jpeg_inst);
-    }
-end:
-    if (data) {
-        lv_free(data);
+static void jpeg_stream_release(jpeg_stream_t *stream)
+{
+    if (stream->alloc) {
+        lv_free(stream->alloc);
     }
+    memset(stream, 0, sizeof(*stream));
+}
 
-#if TIME_DEBUG
-    end = rtos_time_get_current_system_time_ns();
-    time_used = end - start;
-    printf("Get Info used: %lld ns\n", time_used);
-#endif
-    return res;
+static void jpeg_out_conf_from_src(jpeg_out_conf_t *conf, const void *src, lv_image_src_t src_type)
+{
+    memset(conf, 0, sizeof(*conf));
+    if (is_scaled_src(src, src_type)) {
+        const lv_ameba_jpeg_src_t *jpeg_src = src;
+        conf->out_w = jpeg_src->dsc.header.w;
+        conf->out_h = jpeg_src->dsc.header.h;
+        conf->crop_x = jpeg_src->crop_x;
+        conf->crop_y = jpeg_src->crop_y;
+        conf->crop_w = jpeg_src->crop_w;
+        conf->crop_h = jpeg_src->crop_h;
+    }
 }
 
-static lv_result_t decoder_open_cb(lv_image_decoder_t *decoder, lv_image_decoder_dsc_t *dsc)
+/* Source window and output size of a decode, once fitted to the PP constraints */
+typedef struct {
+    bool crop;
+    uint32_t x;
+    uint32_t y;
+    uint32_t w;
+    uint32_t h;
+    uint32_t out_w;
+    uint32_t out_h;
+} jpeg_window_t;
+
+/*
+ * Fit the requested crop window and output size to the PP constraints.
+ * `in_w` x `in_h` is the decoded size in whole MCUs, like JpegDecGetImageInfo's outputWidth/Height.
+ */
+static lv_result_t jpeg_fit_window(const jpeg_out_conf_t *conf, uint32_t in_w, uint32_t in_h, jpeg_window_t *win)
 {
-    LV_UNUSED(decoder);
+    memset(win, 0, sizeof(*win));
+    win->w = in_w;
+    win->h = in_h;
 
-    const uint8_t *jpeg_data_ptr = NULL;
-    uint8_t *data = NULL;
-    uint32_t jpeg_data_len = 0;
+    if (in_w == 0 || in_h == 0) {
+        printf("Image %lux%lu has no pixels.\n", in_w, in_h);
+        return LV_RESULT_INVALID;
+    }
 
-    if (dsc->src_type == LV_IMAGE_SRC_FILE) {
+    if (conf->crop_w && conf->crop_h) {
+        uint32_t x = JPEG_ALIGN_DOWN(conf->crop_x, LV_AMEBA_JPEG_CROP_POS_ALIGN);
+        uint32_t y = JPEG_ALIGN_DOWN(conf->crop_y, LV_AMEBA_JPEG_CROP_POS_ALIGN);
 
-        data = read_file(dsc->src, &jpeg_data_len);
-        if (data == NULL) {
-            LV_LOG_WARN("can't load file %s", dsc->src);
+        if (x >= in_w || y >= in_h) {
+            printf("Crop origin (%lu, %lu) outside %lux%lu image.\n", x, y, in_w, in_h);
             return LV_RESULT_INVALID;
         }
 
-        jpeg_data_ptr = data;
-        //DCache_Clean((uint32_t)jpeg_data_ptr, jpeg_data_len); // Clean before JpegDecDecode
+        /* Widen the window so the aligned origin still covers the requested area */
+        win->w = JPEG_ALIGN_UP(conf->crop_w + conf->crop_x - x, LV_AMEBA_JPEG_CROP_SIZE_ALIGN);
+        win->h = JPEG_ALIGN_UP(conf->crop_h + conf->crop_y - y, LV_AMEBA_JPEG_CROP_SIZE_ALIGN);
+        win->w = LV_MIN(win->w, JPEG_ALIGN_DOWN(in_w - x, LV_AMEBA_JPEG_CROP_SIZE_ALIGN));
+        win->h = LV_MIN(win->h, JPEG_ALIGN_DOWN(in_h - y, LV_AMEBA_JPEG_CROP_SIZE_ALIGN));
 
-    } else if (dsc->src_type == LV_IMAGE_SRC_VARIABLE) {
-        const lv_image_dsc_t *img_dsc = dsc->src;
-        jpeg_data_ptr = img_dsc->data;
-        jpeg_data_len = img_dsc->data_size;
-    } else {
+        /* Less than one aligned block left past the origin */
+        if (win->w == 0 || win->h == 0) {
+            printf("Crop at (%lu, %lu) leaves no %u pixel block of the %lux%lu image.\n",
+                   x, y, LV_AMEBA_JPEG_CROP_SIZE_ALIGN, in_w, in_h);
+            return LV_RESULT_INVALID;
+        }
+
+        win->crop = true;
+        win->x = x;
+        win->y = y;
+    }
+
+    /* A zero output size keeps the size of the window in that direction */
+    win->out_w = conf->out_w ? JPEG_ALIGN_UP(conf->out_w, LV_AMEBA_JPEG_OUT_W_ALIGN) : win->w;
+    win->out_h = conf->out_h ? JPEG_ALIGN_UP(conf->out_h, LV_AMEBA_JPEG_OUT_H_ALIGN) : win->h;
+
+    /* The scaler can't enlarge one direction while shrinking the other */
+    if ((win->out_w > win->w && win->out_h < win->h) || (win->out_w < win->w && win->out_h > win->h)) {
+        printf("PP can't scale %lux%lu to %lux%lu.\n", win->w, win->h, win->out_w, win->out_h);
         return LV_RESULT_INVALID;
     }
+
+    return LV_RESULT_OK;
+}
+
+static lv_result_t jpeg_setup_pp_size(PPConfig *pp_conf, const JpegDecImageInfo *image_info,
+                                      const jpeg_out_conf_t *conf)
+{
+    jpeg_window_t win;
+
+    if (jpeg_fit_window(conf, image_info->outputWidth, image_info->outputHeight, &win) != LV_RESULT_OK) {
+        return LV_RESULT_INVALID;
+    }
+
+    pp_conf->ppInImg.width = image_info->outputWidth;
+    pp_conf->ppInImg.height = image_info->outputHeight;
+
+    if (win.crop) {
+        pp_conf->ppInCrop.enable = 1;
+        pp_conf->ppInCrop.originX = win.x;
+        pp_conf->ppInCrop.originY = win.y;
+        pp_conf->ppInCrop.width = win.w;
+        pp_conf->ppInCrop.height = win.h;
+    }
+
+    pp_conf->ppOutImg.width = win.out_w;
+    pp_conf->ppOutImg.height = win.out_h;
+
+    return LV_RESULT_OK;
+}
+
+/*
+ * Decode a JPEG stream with the PP in combined mode straight into `dst`, or a
+ * new draw buffer when it is NULL. The instances only live for this decode.
+ */
+static lv_draw_buf_t *jpeg_hw_decode(const uint8_t *data, uint32_t size, const jpeg_out_conf_t *conf,
+                                     lv_draw_buf_t *dst)
+{
 #if TIME_DEBUG
     uint64_t start, end;
     uint64_t time_used;
     start = rtos_time_get_current_system_time_ns();
 #endif
 
-    lv_result_t res = LV_RESULT_INVALID;
+    JpegDecInst jpeg_inst = NULL;
+    PPInst pp_inst = NULL;
+    lv_draw_buf_t *decoded_buf = NULL;
+    bool ready = false;
 
-    JpegDecInst jpeg_inst;
-    PPInst pp_inst;
+    rtos_mutex_take(jpeg_hw_lock, MUTEX_WAIT_TIMEOUT);
 
     JpegDecInput jpeg_in;
     JpegDecOutput jpeg_out;
+    JpegDecImageInfo image_info;
     PPConfig pp_conf;
 
     memset(&jpeg_in, 0, sizeof(jpeg_in));
     memset(&jpeg_out, 0, sizeof(jpeg_out));
     memset(&pp_conf, 0, sizeof(pp_conf));
 
-    jpeg_in.streamBuffer.pVirtualAddress = (u32 *)jpeg_data_ptr;
-    jpeg_in.streamBuffer.busAddress = (u32)jpeg_data_ptr;
-    jpeg_in.streamLength = jpeg_data_len;
+    jpeg_in.streamBuffer.pVirtualAddress = (u32 *)data;
+    jpeg_in.streamBuffer.busAddress = (u32)data;
+    jpeg_in.streamLength = size;
 
     if (JpegDecInit(&jpeg_inst) != JPEGDEC_OK) {
         printf("Error: JpegDecInit Failed.\n");
-        res = LV_RESULT_INVALID;
         goto end;
     }
 
+    DCache_Clean((u32)data, size);
+    if (JpegDecGetImageInfo(jpeg_inst, &jpeg_in, &image_info) != JPEGDEC_OK) {
+        printf("Error: JpegDecGetImageInfo Failed.\n");
+        goto end1;
+    }
+
     if (PPInit(&pp_inst) != PP_OK) {
         printf("Error: PPInit Failed.\n");
-        res = LV_RESULT_INVALID;
         goto end1;
     }
 
     if (PPDecCombinedModeEnable(pp_inst, jpeg_inst, PP_PIPELINED_DEC_TYPE_JPEG) != PP_OK) {
         printf("Error: PPDecCombinedModeEnable Failed.\n");
-        res = LV_RESULT_INVALID;
         goto end2;
     }
 
@@ -338,21 +593,33 @@ static lv_result_t decoder_open_cb(lv_image_decoder_t *decoder, lv_image_decoder
         goto end3;
     }
 
-    pp_conf.ppInImg.width = dsc->header.w;
-    pp_conf.ppInImg.height = dsc->header.h;
+    if (jpeg_setup_pp_size(&pp_conf, &image_info, conf) != LV_RESULT_OK) {
+        goto end3;
+    }
+
     /* Jessica */
     pp_conf.ppInImg.videoRange = 1;
     pp_conf.ppOutRgb.rgbTransform = PP_YCBCR2RGB_TRANSFORM_BT_709;
 
-    pp_conf.ppInImg.pixFormat = trans_format_sw2hw(dsc->header.cf);
-    pp_conf.ppOutImg.width = dsc->header.w;
-    pp_conf.ppOutImg.height = dsc->header.h;
-
+    pp_conf.ppInImg.pixFormat = trans_format_sw2hw(trans_format_hw2sw(image_info.outputFormat));
     pp_conf.ppOutImg.pixFormat = purpose_pp_format();
 
-    lv_draw_buf_t *decoded_buf = NULL;
-    uint32_t stride = lv_draw_buf_width_to_stride(dsc->header.w, purpose_lv_format());
-    decoded_buf = lv_draw_buf_create(dsc->header.w, dsc->header.h, purpose_lv_format(), stride);
+    if (dst) {
+        if (dst->header.w != pp_conf.ppOutImg.width || dst->header.h != pp_conf.ppOutImg.height ||
+            dst->header.cf != purpose_lv_format()) {
+            printf("Decode target %ux%u doesn't match the PP output %lux%lu.\n",
+                   dst->header.w, dst->header.h, pp_conf.ppOutImg.width, pp_conf.ppOutImg.height);
+            goto end3;
+        }
+        decoded_buf = dst;
+    } else {
+        uint32_t stride = lv_draw_buf_width_to_stride(pp_conf.ppOutImg.width, purpose_lv_format());
+        decoded_buf = lv_draw_buf_create(pp_conf.ppOutImg.width, pp_conf.ppOutImg.height, purpose_lv_format(), stride);
+        if (!decoded_buf && lv_ameba_img_cache_reclaim(stride * pp_conf.ppOutImg.height)) {
+            /* Unused cached images were holding the memory, try again */
+            decoded_buf = lv_draw_buf_create(pp_conf.ppOutImg.width, pp_conf.ppOutImg.height, purpose_lv_format(), stride);
+        }
+    }
 
     if (!decoded_buf) {
         printf("decoded_buf create failed.\n");
@@ -360,7 +627,6 @@ static lv_result_t decoder_open_cb(lv_image_decoder_t *decoder, lv_image_decoder
     }
     pp_conf.ppOutImg.bufferBusAddr = (u32)decoded_buf->data;
 
-    //DCache_CleanInvalidate(pp_conf.ppOutImg.bufferBusAddr, dsc->header.w * dsc->header.h * LV_COLOR_DEPTH / 8);
     DCache_CleanInvalidate(0xFFFFFFFF, 0xFFFFFFFF); // Clean !!!!
     if (PPSetConfig(pp_inst, &pp_conf) != PP_OK) {
         printf("Error: PPSetConfig Failed.\n");
@@ -368,44 +634,656 @@ static lv_result_t decoder_open_cb(lv_image_decoder_t *decoder, lv_image_decoder
     }
 
     if (JpegDecDecode(jpeg_inst, &jpeg_in, &jpeg_out) == JPEGDEC_FRAME_READY) {
-        dsc->header.cf = purpose_lv_format(); // Format changed after PP process
-        dsc->decoded = decoded_buf;
-        res = LV_RESULT_OK;
+        DCache_Invalidate((u32)decoded_buf->data, decoded_buf->data_size);
+        ready = true;
     }
 end3:
-    if (pp_inst) {
-        PPDecCombinedModeDisable(pp_inst, jpeg_inst);
-    }
+    PPDecCombinedModeDisable(pp_inst, jpeg_inst);
 end2:
-    if (pp_inst) {
-        PPRelease(pp_inst);
-    }
+    PPRelease(pp_inst);
 end1:
-    if (jpeg_inst) {
-        JpegDecRelease(jpeg_inst);
-    }
+    JpegDecRelease(jpeg_inst);
 end:
-    if (data) {
-        lv_free(data);
-    }
-    if (decoded_buf && (res != LV_RESULT_OK)) {
-        printf("Decode open flow failed and release decoded_buf.\n");
-        lv_draw_buf_destroy(decoded_buf);
+    if (decoded_buf && !ready) {
+        if (decoded_buf != dst) {
+            printf("Decode open flow failed and release decoded_buf.\n");
+            lv_draw_buf_destroy(decoded_buf);
+        }
+        decoded_buf = NULL;
     }
+    rtos_mutex_give(jpeg_hw_lock);
 #if TIME_DEBUG
     end = rtos_time_get_current_system_time_ns();
     time_used = end - start;
     printf("Decode Time used: %lld ns\n", time_used);
 #endif
 
-    return res;
+    return decoded_buf;
+}
+
+#if LV_USE_LIBJPEG_TURBO
+typedef struct {
+    struct jpeg_error_mgr pub;
+    jmp_buf jb;
+} turbo_error_t;
+
+static void turbo_error_exit(j_common_ptr cinfo)
+{
+    turbo_error_t *err = (turbo_error_t *)cinfo->err;
+    longjmp(err->jb, 1);
+}
+
+/*
+ * For streams the HW can't take: let the IDCT shrink by up to 1/8 while the
+ * result still covers the requested size, then pick the remaining pixels.
+ * The window and output size are fitted like the HW does, so a source decodes
+ * to the same size and area on either backend. The MCU padding past the image
+ * edge repeats the last decoded pixel.
+ */
+static lv_draw_buf_t *jpeg_turbo_decode_scaled(const uint8_t *data, uint32_t size, const jpeg_out_conf_t *conf)
+{
+    struct jpeg_decompress_struct cinfo;
+    turbo_error_t jerr;
+    jpeg_window_t win;
+    lv_draw_buf_t *volatile out = NULL;
+    uint8_t *volatile row = NULL;
+    lv_color_format_t cf = purpose_lv_format();
+    uint32_t px_size = lv_color_format_get_size(cf);
+
+    cinfo.err = jpeg_std_error(&jerr.pub);
+    jerr.pub.error_exit = turbo_error_exit;
+    if (setjmp(jerr.jb)) {
+        printf("Error: libjpeg-turbo decode failed.\n");
+        jpeg_destroy_decompress(&cinfo);
+        lv_free(row);
+        if (out) {
+            lv_draw_buf_destroy(out);
+        }
+        return NULL;
+    }
+
+    jpeg_create_decompress(&cinfo);
+    jpeg_mem_src(&cinfo, (unsigned char *)data, size);
+    jpeg_read_header(&cinfo, TRUE);
+
+    if (jpeg_fit_window(conf, JPEG_ALIGN_UP(cinfo.image_width, 16), JPEG_ALIGN_UP(cinfo.image_height, 16),
+                        &win) != LV_RESULT_OK) {
+        jpeg_destroy_decompress(&cinfo);
+        return NULL;
+    }
+
+    uint32_t out_w = win.out_w;
+    uint32_t out_h = win.out_h;
+    uint32_t denom = 8;
+    while (denom > 1 && (win.w / denom < out_w || win.h / denom < out_h)) {
+        denom /= 2;
+    }
+
+    cinfo.scale_num = 1;
+    cinfo.scale_denom = denom;
+    cinfo.out_color_space = px_size == 2 ? JCS_RGB565 : JCS_EXT_BGRX;
+    jpeg_start_decompress(&cinfo);
+
+    out = lv_draw_buf_create(out_w, out_h, cf, lv_draw_buf_width_to_stride(out_w, cf));
+    row = lv_malloc(cinfo.output_width * px_size);
+    if (out == NULL || row == NULL) {
+        ERREXIT(&cinfo, JERR_OUT_OF_MEMORY);
+    }
+
+    uint32_t line = 0;
+    for (uint32_t oy = 0; oy < out_h; oy++) {
+        uint32_t want = LV_MIN((win.y + oy * win.h / out_h) / denom, cinfo.output_height - 1);
+        while (line <= want) {
+            JSAMPROW r = row;
+            jpeg_read_scanlines(&cinfo, &r, 1);
+            line++;
+        }
+
+        uint8_t *dst = out->data + oy * out->header.stride;
+        for (uint32_t ox = 0; ox < out_w; ox++) {
+            uint32_t x = LV_MIN((win.x + ox * win.w / out_w) / denom, cinfo.output_width - 1);
+            if (px_size == 2) {
+                ((uint16_t *)dst)[ox] = ((uint16_t *)row)[x];
+            } else {
+                ((uint32_t *)dst)[ox] = ((uint32_t *)row)[x];
+            }
+        }
+    }
+
+    /* Rows below the window are not needed */
+    if (cinfo.output_scanline < cinfo.output_height) {
+        jpeg_abort_decompress(&cinfo);
+    } else {
+        jpeg_finish_decompress(&cinfo);
+    }
+    jpeg_destroy_decompress(&cinfo);
+    lv_free(row);
+
+    return out;
+}
+#endif
+
+/* Run the backend chosen by decoder_info_cb / lv_ameba_jpeg_decode_src */
+static lv_draw_buf_t *jpeg_decode_with(lv_ameba_jpeg_backend_t backend, const uint8_t *data, uint32_t size,
+                                       const jpeg_out_conf_t *conf)
+{
+    lv_draw_buf_t *buf = NULL;
+
+    if (backend == LV_AMEBA_JPEG_BACKEND_HW) {
+        buf = jpeg_hw_decode(data, size, conf, NULL);
+#if LV_USE_LIBJPEG_TURBO
+    } else if (backend == LV_AMEBA_JPEG_BACKEND_LIBJPEG_TURBO_SCALED) {
+        buf = jpeg_turbo_decode_scaled(data, size, conf);
+#endif
+    }
+
+    if (buf) {
+        jpeg_stats.decodes[backend]++;
+        jpeg_stats.last_backend = backend;
+    } else {
+        jpeg_stats.failed++;
+    }
+
+    return buf;
+}
+
+/*
+ * Pick the fastest backend able to decode the stream: the HW when it supports
+ * the stream, DCT-domain downscaling in libjpeg-turbo for scaled sources it
+ * doesn't, otherwise leave the image to LVGL's libjpeg-turbo decoder.
+ */
+static lv_ameba_jpeg_backend_t jpeg_route(const jpeg_probe_t *probe, bool scaled)
+{
+    if (jpeg_hw_capable(probe)) {
+        return LV_AMEBA_JPEG_BACKEND_HW;
+    }
+
+#if LV_USE_LIBJPEG_TURBO
+    if (scaled) {
+        return LV_AMEBA_JPEG_BACKEND_LIBJPEG_TURBO_SCALED;
+    }
+#else
+    LV_UNUSED(scaled);
+#endif
+
+    return LV_AMEBA_JPEG_BACKEND_LIBJPEG_TURBO;
+}
+
+static lv_result_t decoder_info_cb(lv_image_decoder_t *decoder, lv_image_decoder_dsc_t *dsc, lv_image_header_t *header)
+{
+    LV_UNUSED(decoder);
+    const void *src = dsc->src;
+    lv_image_src_t src_type = dsc->src_type;
+    bool scaled = is_scaled_src(src, src_type);
+    jpeg_probe_t probe;
+
+    if (src_type == LV_IMAGE_SRC_VARIABLE && !scaled) {
+        const lv_image_dsc_t *img_dsc = src;
+        /* Decoded pixels (e.g. MJPEG frames) may start with FF D8 FF too */
+        if (img_dsc->header.cf != LV_COLOR_FORMAT_RAW && img_dsc->header.cf != LV_COLOR_FORMAT_UNKNOWN) {
+            return LV_RESULT_INVALID;
+        }
+    }
+
+#if TIME_DEBUG
+    uint64_t start, end;
+    uint64_t time_used;
+    start = rtos_time_get_current_system_time_ns();
+#endif
+
+    if (jpeg_probe_src(src, src_type, &probe) != LV_RESULT_OK) {
+        return LV_RESULT_INVALID;
+    }
+
+    lv_ameba_jpeg_backend_t backend = jpeg_route(&probe, scaled);
+
+#if TIME_DEBUG
+    end = rtos_time_get_current_system_time_ns();
+    time_used = end - start;
+    printf("Get Info used: %lld ns, backend %d\n", time_used, backend);
+#endif
+
+    if (backend == LV_AMEBA_JPEG_BACKEND_LIBJPEG_TURBO) {
+        /* Not ours, the next decoder in the list gets it */
+        jpeg_stats.declined++;
+        return LV_RESULT_INVALID;
+    }
+
+    if (scaled) {
+        /* The output size is requested by the source, zero sizes follow the crop window */
+        jpeg_out_conf_t conf;
+        jpeg_window_t win;
+
+        jpeg_out_conf_from_src(&conf, src, src_type);
+        if (jpeg_fit_window(&conf, JPEG_ALIGN_UP(probe.w, 16), JPEG_ALIGN_UP(probe.h, 16), &win) != LV_RESULT_OK) {
+            return LV_RESULT_INVALID;
+        }
+        header->w = win.out_w;
+        header->h = win.out_h;
+    } else {
+        /* The HW writes whole MCUs, like JpegDecGetImageInfo's outputWidth/Height */
+        header->w = JPEG_ALIGN_UP(probe.w, 16);
+        header->h = JPEG_ALIGN_UP(probe.h, 16);
+    }
+    header->cf = purpose_lv_format();
+    header->flags = backend == LV_AMEBA_JPEG_BACKEND_HW ? 0 : LV_AMEBA_JPEG_FLAG_TURBO;
+
+    return LV_RESULT_OK;
+}
+
+#if LV_USE_LIBJPEG_TURBO
+/*
+ * Large images are streamed through libjpeg-turbo in bands of whole rows of
+ * the drawn columns. One decode pass per draw walks down the image, rows above
+ * the draw are skipped without the IDCT and columns beside it are cropped off.
+ * Bands go to a small pool of their own so redraws find them again without
+ * pushing whole images out of the decoded-image cache.
+ */
+typedef struct {
+    lv_ameba_img_cache_key_t key;   /**< The image, the band area in crop_* */
+    char *path;                 /**< Owned copy of the path for file sources */
+    lv_draw_buf_t *buf;
+    uint32_t used;              /**< LRU stamp */
+    uint16_t ref_cnt;           /**< Draws currently using `buf` */
+    bool ready;                 /**< `buf` holds the decoded band */
+} jpeg_band_t;
+
+static jpeg_band_t jpeg_band_pool[LV_AMEBA_JPEG_TILE_POOL_CNT];
+static uint32_t jpeg_band_clock;
+static rtos_mutex_t jpeg_band_lock;
+
+/* Take a reference on the band of `key`, `*hit` tells whether it still has to be decoded */
+static jpeg_band_t *band_pool_get(const lv_ameba_img_cache_key_t *key, bool *hit)
+{
+    jpeg_band_t *victim = NULL;
+    jpeg_band_t *band = NULL;
+
+    rtos_mutex_take(jpeg_band_lock, MUTEX_WAIT_TIMEOUT);
+
+    for (int i = 0; i < LV_AMEBA_JPEG_TILE_POOL_CNT; i++) {
+        jpeg_band_t *b = &jpeg_band_pool[i];
+        if (b->ready && lv_ameba_img_cache_key_equal(&b->key, key)) {
+            band = b;
+            break;
+        }
+        if (b->ref_cnt == 0 && (victim == NULL || b->used < victim->used)) {
+            victim = b;
+        }
+    }
+
+    *hit = band != NULL;
+    if (band == NULL && victim) {
+        band = victim;
+        band->ready = false;
+        if (band->path) {
+            lv_free(band->path);
+            band->path = NULL;
+        }
+        band->key = *key;
+        if (key->src_type == LV_IMAGE_SRC_FILE) {
+            band->path = lv_strdup(key->src);
+            band->key.src = band->path;
+            if (band->path == NULL) {
+                band = NULL;
+            }
+        }
+    }
+
+    if (band) {
+        band->ref_cnt++;
+        band->used = ++jpeg_band_clock;
+    }
+
+    rtos_mutex_give(jpeg_band_lock);
+
+    return band;
+}
+
+static void band_pool_put(jpeg_band_t *band)
+{
+    rtos_mutex_take(jpeg_band_lock, MUTEX_WAIT_TIMEOUT);
+    band->ref_cnt--;
+    rtos_mutex_give(jpeg_band_lock);
+}
+
+/* Decode state of an image drawn band by band through get_area_cb */
+typedef struct {
+    jpeg_stream_t stream;       /**< Loaded on the first band that isn't pooled */
+    lv_ameba_img_cache_key_t key;
+    jpeg_band_t *band;          /**< Band currently handed out in `dsc->decoded` */
+    struct jpeg_decompress_struct cinfo;
+    turbo_error_t jerr;
+    bool created;               /**< `cinfo` exists */
+    bool header_read;           /**< jpeg_read_header done in the current pass */
+    bool running;               /**< jpeg_start_decompress done, `span_*` cropped */
+    uint32_t img_w;             /**< From the probe, the header is MCU aligned */
+    uint32_t img_h;
+    uint32_t align;             /**< iMCU column width jpeg_crop_scanline aligns to */
+    uint32_t span_x;            /**< Columns decoded for the current draw, iMCU aligned */
+    uint32_t span_w;
+    uint32_t pass_x;            /**< Columns the running pass was cropped to */
+    uint32_t pass_w;
+    uint32_t band_h;
+} jpeg_tiled_ctx_t;
+
+/* Only call between setjmp(ctx->jerr.jb) and its end, libjpeg errors longjmp there */
+static void tiled_read_header(jpeg_tiled_ctx_t *ctx)
+{
+    if (ctx->header_read) {
+        return;
+    }
+
+    jpeg_mem_src(&ctx->cinfo, (unsigned char *)ctx->stream.data, ctx->stream.size);
+    jpeg_read_header(&ctx->cinfo, TRUE);
+    ctx->cinfo.out_color_space = lv_color_format_get_size(purpose_lv_format()) == 2 ? JCS_RGB565 : JCS_EXT_BGRX;
+    ctx->header_read = true;
+}
+
+/* Drop the pass in progress, the next one starts again at the stream header */
+static void tiled_reset(jpeg_tiled_ctx_t *ctx)
+{
+    if (ctx->created) {
+        jpeg_abort_decompress(&ctx->cinfo);
+    }
+    ctx->header_read = false;
+    ctx->running = false;
+}
+
+static lv_result_t tiled_prepare(jpeg_tiled_ctx_t *ctx, lv_image_decoder_dsc_t *dsc)
+{
+    if (ctx->stream.data == NULL && jpeg_stream_load(dsc->src, dsc->src_type, &ctx->stream) != LV_RESULT_OK) {
+        return LV_RESULT_INVALID;
+    }
+
+    if (!ctx->created) {
+        ctx->cinfo.err = jpeg_std_error(&ctx->jerr.pub);
+        ctx->jerr.pub.error_exit = turbo_error_exit;
+        jpeg_create_decompress(&ctx->cinfo);
+        ctx->created = true;
+    }
+
+    return LV_RESULT_OK;
+}
+
+/*
+ * Columns of `full_area` the bands of this draw cover, rounded out to iMCU
+ * columns like jpeg_crop_scanline does. Known from the probe, so draws served
+ * from the pool never load the stream.
+ */
+static lv_result_t tiled_set_span(jpeg_tiled_ctx_t *ctx, const lv_area_t *full_area)
+{
+    /* The header is padded to whole MCUs, the pixels past the image are not drawn */
+    int32_t x1 = LV_MAX(full_area->x1, 0);
+    int32_t x2 = LV_MIN(full_area->x2, (int32_t)ctx->img_w - 1);
+    if (x1 > x2 || full_area->y1 >= (int32_t)ctx->img_h) {
+        return LV_RESULT_INVALID;
+    }
+
+    uint32_t row_size = lv_draw_buf_width_to_stride(x2 - x1 + ctx->align, purpose_lv_format());
+
+    ctx->span_x = x1 / ctx->align * ctx->align;
+    ctx->span_w = x2 + 1 - ctx->span_x;
+    ctx->band_h = LV_MAX(LV_AMEBA_JPEG_TILE_SIZE / row_size, 1);
+
+    return LV_RESULT_OK;
+}
+
+/* Run the pass down to row `y` of the span, starting a new one if it is past it or cropped differently */
+static void tiled_seek(jpeg_tiled_ctx_t *ctx, uint32_t y)
+{
+    if (ctx->running && (ctx->pass_x != ctx->span_x || ctx->pass_w != ctx->span_w ||
+                         ctx->cinfo.output_scanline > y)) {
+        tiled_reset(ctx);
+    }
+
+    if (!ctx->running) {
+        JDIMENSION x = ctx->span_x;
+        JDIMENSION w = ctx->span_w;
+
+        tiled_read_header(ctx);
+        jpeg_start_decompress(&ctx->cinfo);
+        jpeg_crop_scanline(&ctx->cinfo, &x, &w);
+        ctx->pass_x = x;
+        ctx->pass_w = w;
+        ctx->running = true;
+    }
+
+    if (ctx->cinfo.output_scanline < y) {
+        jpeg_skip_scanlines(&ctx->cinfo, y - ctx->cinfo.output_scanline);
+    }
+}
+
+static void tiled_put_band(jpeg_tiled_ctx_t *ctx)
+{
+    if (ctx->band) {
+        band_pool_put(ctx->band);
+    }
+    ctx->band = NULL;
+}
+
+static lv_result_t tiled_get_band(jpeg_tiled_ctx_t *ctx, lv_image_decoder_dsc_t *dsc, const lv_area_t *band_area)
+{
+    lv_ameba_img_cache_key_t key = ctx->key;
+    lv_color_format_t cf = purpose_lv_format();
+    bool hit;
+
+    key.crop_x = band_area->x1;
+    key.crop_y = band_area->y1;
+    key.crop_w = lv_area_get_width(band_area);
+    key.crop_h = lv_area_get_height(band_area);
+
+    ctx->band = band_pool_get(&key, &hit);
+    if (ctx->band == NULL) {
+        printf("Error: all %d JPEG bands in use.\n", LV_AMEBA_JPEG_TILE_POOL_CNT);
+        return LV_RESULT_INVALID;
+    }
+
+    if (hit) {
+        return LV_RESULT_OK;
+    }
+
+    if (tiled_prepare(ctx, dsc) != LV_RESULT_OK) {
+        tiled_put_band(ctx);
+        return LV_RESULT_INVALID;
+    }
+
+    /* Only this draw holds the band until it is ready, keep the buffer if it has the right size */
+    jpeg_band_t *band = ctx->band;
+    if (band->buf && (band->buf->header.w != key.crop_w || band->buf->header.h != key.crop_h)) {
+        lv_draw_buf_destroy(band->buf);
+        band->buf = NULL;
+    }
+    if (band->buf == NULL) {
+        band->buf = lv_draw_buf_create(key.crop_w, key.crop_h, cf, lv_draw_buf_width_to_stride(key.crop_w, cf));
+    }
+    if (band->buf == NULL) {
+        printf("JPEG band create failed.\n");
+        tiled_put_band(ctx);
+        return LV_RESULT_INVALID;
+    }
+
+    if (setjmp(ctx->jerr.jb)) {
+        printf("Error: libjpeg-turbo band decode failed.\n");
+        tiled_reset(ctx);
+        tiled_put_band(ctx);
+        return LV_RESULT_INVALID;
+    }
+
+    tiled_seek(ctx, key.crop_y);
+    if (ctx->pass_x != ctx->span_x || ctx->pass_w != ctx->span_w) {
+        printf("Error: libjpeg-turbo cropped to %lu+%lu, expected %lu+%lu.\n",
+               ctx->pass_x, ctx->pass_w, ctx->span_x, ctx->span_w);
+        tiled_reset(ctx);
+        tiled_put_band(ctx);
+        return LV_RESULT_INVALID;
+    }
+
+    for (uint32_t row = 0; row < key.crop_h; row++) {
+        JSAMPROW r = band->buf->data + row * band->buf->header.stride;
+        if (jpeg_read_scanlines(&ctx->cinfo, &r, 1) != 1) {
+            /* Past the last row, the band area is off */
+            tiled_reset(ctx);
+            tiled_put_band(ctx);
+            return LV_RESULT_INVALID;
+        }
+    }
+    band->ready = true;
+
+    return LV_RESULT_OK;
+}
+
+/*
+ * Hand out the bands covering `full_area` top to bottom. The first call of a
+ * draw fixes the columns, the pass keeps running across draws further down.
+ */
+static lv_result_t decoder_get_area_cb(lv_image_decoder_t *decoder, lv_image_decoder_dsc_t *dsc,
+                                       const lv_area_t *full_area, lv_area_t *decoded_area)
+{
+    LV_UNUSED(decoder);
+    jpeg_tiled_ctx_t *ctx = dsc->user_data;
+    int32_t y;
+
+    if (ctx == NULL) {
+        return LV_RESULT_INVALID;
+    }
+
+    tiled_put_band(ctx);
+    dsc->decoded = NULL;
+
+    if (decoded_area->y1 == LV_COORD_MIN) {
+        if (tiled_set_span(ctx, full_area) != LV_RESULT_OK) {
+            return LV_RESULT_INVALID;
+        }
+        /* On the band grid so redraws of the same columns hit the pool */
+        y = LV_MAX(full_area->y1, 0);
+        y -= y % ctx->band_h;
+    } else {
+        y = decoded_area->y2 + 1;
+    }
+
+    if (y > full_area->y2 || y >= (int32_t)ctx->img_h) {
+        return LV_RESULT_INVALID;
+    }
+
+    lv_area_set(decoded_area, ctx->span_x, y, ctx->span_x + ctx->span_w - 1,
+                LV_MIN(y + ctx->band_h, ctx->img_h) - 1);
+
+    if (tiled_get_band(ctx, dsc, decoded_area) != LV_RESULT_OK) {
+        return LV_RESULT_INVALID;
+    }
+    dsc->decoded = ctx->band->buf;
+
+    return LV_RESULT_OK;
+}
+
+/* Defer decoding to get_area_cb, `stream` is taken over if already loaded */
+static lv_result_t jpeg_open_tiled(lv_image_decoder_dsc_t *dsc, const lv_ameba_img_cache_key_t *key,
+                                   jpeg_stream_t *stream)
+{
+    jpeg_probe_t probe;
+
+    jpeg_tiled_ctx_t *ctx = lv_malloc_zeroed(sizeof(jpeg_tiled_ctx_t));
+    if (ctx == NULL || jpeg_probe_src(dsc->src, dsc->src_type, &probe) != LV_RESULT_OK) {
+        lv_free(ctx);
+        jpeg_stream_release(stream);
+        return LV_RESULT_INVALID;
+    }
+
+    ctx->key = *key;
+    ctx->stream = *stream;
+    ctx->img_w = probe.w;
+    ctx->img_h = probe.h;
+    ctx->align = DCTSIZE * (probe.comps == 1 ? 1 : LV_MAX(probe.max_h_samp, 1));
+
+    dsc->user_data = ctx;
+    dsc->decoded = NULL;
+    dsc->header.cf = purpose_lv_format();
+
+    return LV_RESULT_OK;
+}
+
+static void jpeg_close_tiled(jpeg_tiled_ctx_t *ctx)
+{
+    tiled_put_band(ctx);
+    if (ctx->created) {
+        jpeg_destroy_decompress(&ctx->cinfo);
+    }
+    jpeg_stream_release(&ctx->stream);
+    lv_free(ctx);
+}
+#endif
+
+static lv_result_t decoder_open_cb(lv_image_decoder_t *decoder, lv_image_decoder_dsc_t *dsc)
+{
+    LV_UNUSED(decoder);
+
+    jpeg_out_conf_t conf;
+    jpeg_stream_t stream;
+    lv_ameba_img_cache_key_t key;
+    bool scaled = is_scaled_src(dsc->src, dsc->src_type);
+    lv_ameba_jpeg_backend_t backend = (dsc->header.flags & LV_AMEBA_JPEG_FLAG_TURBO) ?
+                                      LV_AMEBA_JPEG_BACKEND_LIBJPEG_TURBO_SCALED : LV_AMEBA_JPEG_BACKEND_HW;
+
+    lv_ameba_img_cache_key_init(&key, dsc->src);
+    lv_draw_buf_t *decoded_buf = lv_ameba_img_cache_acquire(&key);
+    if (decoded_buf) {
+        goto done;
+    }
+
+    memset(&stream, 0, sizeof(stream));
+    uint32_t full_size = dsc->header.w * dsc->header.h * lv_color_format_get_size(purpose_lv_format());
+#if LV_USE_LIBJPEG_TURBO
+    if (backend == LV_AMEBA_JPEG_BACKEND_HW && !scaled && full_size > LV_AMEBA_JPEG_TILED_MIN_SIZE) {
+        return jpeg_open_tiled(dsc, &key, &stream);
+    }
+#endif
+
+    jpeg_out_conf_from_src(&conf, dsc->src, dsc->src_type);
+
+    if (jpeg_stream_load(dsc->src, dsc->src_type, &stream) != LV_RESULT_OK) {
+        return LV_RESULT_INVALID;
+    }
+
+    decoded_buf = jpeg_decode_with(backend, stream.data, stream.size, &conf);
+#if LV_USE_LIBJPEG_TURBO
+    if (decoded_buf == NULL && backend == LV_AMEBA_JPEG_BACKEND_HW && !scaled && full_size > LV_AMEBA_JPEG_TILE_SIZE) {
+        /* Most likely no contiguous block for the whole image, a band at a time may still fit */
+        return jpeg_open_tiled(dsc, &key, &stream);
+    }
+#else
+    LV_UNUSED(full_size);
+#endif
+    jpeg_stream_release(&stream);
+
+    if (decoded_buf == NULL) {
+        return LV_RESULT_INVALID;
+    }
+
+    /* If it doesn't fit the cache budget the decoder keeps ownership, see decoder_close_cb */
+    lv_ameba_img_cache_add(&key, decoded_buf, true);
+
+done:
+    dsc->header.cf = purpose_lv_format(); // Format changed after PP process
+    dsc->header.w = decoded_buf->header.w;
+    dsc->header.h = decoded_buf->header.h;
+    dsc->decoded = decoded_buf;
+
+    return LV_RESULT_OK;
 }
 
 static void decoder_close_cb(lv_image_decoder_t *decoder, lv_image_decoder_dsc_t *dsc)
 {
     LV_UNUSED(decoder);
 
-    if (dsc->decoded) {
+#if LV_USE_LIBJPEG_TURBO
+    if (dsc->user_data) {
+        jpeg_close_tiled(dsc->user_data);
+        dsc->user_data = NULL;
+        dsc->decoded = NULL;
+    }
+#endif
+
+    if (dsc->decoded && !lv_ameba_img_cache_release(dsc->decoded)) {
         lv_draw_buf_destroy((lv_draw_buf_t *)dsc->decoded);
     }
 }
@@ -414,9 +1292,16 @@ void lv_ameba_jpeg_init(void) {
     lv_image_decoder_t *dec = lv_image_decoder_create();
     lv_image_decoder_set_info_cb(dec, decoder_info_cb);
     lv_image_decoder_set_open_cb(dec, decoder_open_cb);
+#if LV_USE_LIBJPEG_TURBO
+    lv_image_decoder_set_get_area_cb(dec, decoder_get_area_cb);
+    rtos_mutex_create(&jpeg_band_lock);
+#endif
     lv_image_decoder_set_close_cb(dec, decoder_close_cb);
     dec->name = DECODER_NAME;
 
+    rtos_mutex_create(&jpeg_hw_lock);
+    lv_ameba_img_cache_init();
+
     RCC_PeriphClockCmd(APBPeriph_MJPEG, APBPeriph_MJPEG_CLOCK, ENABLE);
     hx170dec_init();
 }
@@ -424,3 +1309,137 @@ void lv_ameba_jpeg_init(void) {
 void lv_ameba_jpeg_deinit(void) {
     // TODO
 }
+
+lv_result_t lv_ameba_jpeg_hw_out_size(const uint8_t *data, uint32_t size, uint16_t *out_w, uint16_t *out_h)
+{
+    jpeg_mem_reader_t mem = { data, size };
+    jpeg_out_conf_t conf;
+    jpeg_window_t win;
+    jpeg_probe_t probe;
+
+    if (jpeg_probe(probe_read_mem, &mem, &probe) != LV_RESULT_OK || !jpeg_hw_capable(&probe)) {
+        return LV_RESULT_INVALID;
+    }
+
+    memset(&conf, 0, sizeof(conf));
+    conf.out_w = *out_w;
+    conf.out_h = *out_h;
+    if (jpeg_fit_window(&conf, JPEG_ALIGN_UP(probe.w, 16), JPEG_ALIGN_UP(probe.h, 16), &win) != LV_RESULT_OK) {
+        return LV_RESULT_INVALID;
+    }
+
+    *out_w = win.out_w;
+    *out_h = win.out_h;
+
+    return LV_RESULT_OK;
+}
+
+lv_result_t lv_ameba_jpeg_hw_decode_to(const uint8_t *data, uint32_t size, uint16_t out_w, uint16_t out_h,
+                                       lv_draw_buf_t *buf)
+{
+    jpeg_out_conf_t conf;
+
+    memset(&conf, 0, sizeof(conf));
+    conf.out_w = out_w;
+    conf.out_h = out_h;
+
+    return jpeg_hw_decode(data, size, &conf, buf) ? LV_RESULT_OK : LV_RESULT_INVALID;
+}
+
+lv_color_format_t lv_ameba_jpeg_lv_out_format(void)
+{
+    return purpose_lv_format();
+}
+
+lv_result_t lv_ameba_jpeg_decode_src(const void *src, lv_draw_buf_t **out)
+{
+    lv_image_src_t src_type = lv_image_src_get_type(src);
+    jpeg_out_conf_t conf;
+    jpeg_stream_t stream;
+    jpeg_probe_t probe;
+
+    *out = NULL;
+
+    /* Only the headers are read to find out whether this is a JPEG we can take */
+    if (jpeg_probe_src(src, src_type, &probe) != LV_RESULT_OK) {
+        return LV_RESULT_INVALID;
+    }
+
+    lv_ameba_jpeg_backend_t backend = jpeg_route(&probe, is_scaled_src(src, src_type));
+    if (backend == LV_AMEBA_JPEG_BACKEND_LIBJPEG_TURBO) {
+        return LV_RESULT_INVALID;
+    }
+
+    if (jpeg_stream_load(src, src_type, &stream) != LV_RESULT_OK) {
+        return LV_RESULT_INVALID;
+    }
+
+    jpeg_out_conf_from_src(&conf, src, src_type);
+    *out = jpeg_decode_with(backend, stream.data, stream.size, &conf);
+    jpeg_stream_release(&stream);
+
+    return *out ? LV_RESULT_OK : LV_RESULT_INVALID;
+}
+
+void lv_ameba_jpeg_get_stats(lv_ameba_jpeg_stats_t *stats)
+{
+    *stats = jpeg_stats;
+#ifdef CONFIG_NEON
+    stats->simd = true;
+#endif
+}
+
+static lv_result_t jpeg_src_init(lv_ameba_jpeg_src_t *src, uint16_t out_w, uint16_t out_h, const lv_area_t *crop)
+{
+    memset(src, 0, sizeof(*src));
+
+    if (crop) {
+        /* Clip the window to the image origin, the far edges are clipped at decode time */
+        int32_t x1 = LV_MAX(crop->x1, 0);
+        int32_t y1 = LV_MAX(crop->y1, 0);
+        int32_t x2 = LV_MIN(crop->x2, UINT16_MAX - 1);
+        int32_t y2 = LV_MIN(crop->y2, UINT16_MAX - 1);
+
+        if (x2 < x1 || y2 < y1) {
+            LV_LOG_WARN("crop window (%d, %d) (%d, %d) outside the image",
+                        (int)crop->x1, (int)crop->y1, (int)crop->x2, (int)crop->y2);
+            return LV_RESULT_INVALID;
+        }
+
+        src->crop_x = x1;
+        src->crop_y = y1;
+        src->crop_w = x2 - x1 + 1;
+        src->crop_h = y2 - y1 + 1;
+    }
+
+    src->dsc.header.magic = LV_IMAGE_HEADER_MAGIC;
+    src->dsc.header.cf = LV_COLOR_FORMAT_RAW;
+    src->dsc.header.flags = LV_AMEBA_JPEG_FLAG_SCALED;
+    src->dsc.header.w = JPEG_ALIGN_UP(out_w, LV_AMEBA_JPEG_OUT_W_ALIGN);
+    src->dsc.header.h = JPEG_ALIGN_UP(out_h, LV_AMEBA_JPEG_OUT_H_ALIGN);
+
+    return LV_RESULT_OK;
+}
+
+lv_result_t lv_ameba_jpeg_src_init_file(lv_ameba_jpeg_src_t *src, const char *path,
+                                        uint16_t out_w, uint16_t out_h, const lv_area_t *crop)
+{
+    if (jpeg_src_init(src, out_w, out_h, crop) != LV_RESULT_OK) {
+        return LV_RESULT_INVALID;
+    }
+    src->path = path;
+
+    return LV_RESULT_OK;
+}
+
+lv_result_t lv_ameba_jpeg_src_init_data(lv_ameba_jpeg_src_t *src, const void *data, uint32_t data_size,
+                                        uint16_t out_w, uint16_t out_h, const lv_area_t *crop)
+{
+    if (jpeg_src_init(src, out_w, out_h, crop) != LV_RESULT_OK) {
+        return LV_RESULT_INVALID;
+    }
+    src->dsc.data = data;
+    src->dsc.data_size = data_size;
+
+    return LV_RESULT_OK;
+}
@@ -0,0 +1,589 @@
+/*
+ * Copyright (c) 2026 Realtek Semiconductor Corp.
+ * All rights reserved.
+ *
+ * Licensed under the Realtek License, Version 1.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License from Realtek
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "lv_ameba_mjpeg.h"
+#include "lv_ameba_jpeg_private.h"
+#include "lv_fs_romfs.h"
+
+#include "ameba_soc.h"
+#include "os_wrapper.h"
+
+#include "src/stdlib/lv_mem.h"
+#include "src/stdlib/lv_string.h"
+#include "src/misc/lv_fs.h"
+#include "src/misc/lv_log.h"
+
+#define MJPEG_DEBUG 0
+
+/* Frame N is shown from one buffer while frame N+1 is decoded into the other */
+#define MJPEG_FRAME_BUF_CNT     2
+#define MJPEG_SCAN_CHUNK        4096
+
+#define FOURCC(a, b, c, d)      ((uint32_t)(a) | ((uint32_t)(b) << 8) | ((uint32_t)(c) << 16) | ((uint32_t)(d) << 24))
+
+typedef enum {
+    FRAME_FREE,
+    FRAME_READY,
+    FRAME_SHOWN,
+} mjpeg_frame_state_t;
+
+typedef struct {
+    lv_draw_buf_t *buf;
+    lv_image_dsc_t dsc;         /**< Wraps `buf` for `lv_image_set_src()` */
+    volatile mjpeg_frame_state_t state;
+    uint32_t pts_ms;
+    uint32_t seq;
+} mjpeg_frame_t;
+
+/* Location of one JPEG frame in the file */
+typedef struct {
+    uint32_t offset;
+    uint32_t size;
+} mjpeg_index_t;
+
+struct _lv_ameba_mjpeg_t {
+    lv_obj_t *img;
+    lv_timer_t *timer;
+
+    lv_fs_file_t file;
+    bool file_open;
+    const uint8_t *mapped;      /**< The clip in place when it is on romfs */
+    mjpeg_index_t *index;
+    uint32_t frame_cnt;
+    uint32_t index_cap;
+    uint32_t frame_us;
+    uint32_t fps;
+
+    uint16_t out_w;
+    uint16_t out_h;
+    uint8_t *stream;
+    uint32_t stream_cap;
+    const uint8_t *frame_data;  /**< JPEG data of the frame being decoded */
+
+    mjpeg_frame_t frames[MJPEG_FRAME_BUF_CNT];
+
+    rtos_sema_t free_sema;      /**< Counts FRAME_FREE buffers */
+    rtos_sema_t wake_sema;      /**< Restarts the task parked at the end of the clip */
+    rtos_sema_t exit_sema;
+    bool task_running;
+    volatile bool exit;
+    volatile bool playing;
+    volatile bool loop;
+    volatile uint32_t seq;      /**< Next frame to decode, keeps counting across loops */
+    volatile uint32_t clock_base;
+    uint32_t pause_elapsed;
+
+    volatile uint32_t shown;
+    volatile uint32_t dropped;
+    volatile uint32_t decode_us;
+};
+
+static uint32_t mjpeg_elapsed_ms(lv_ameba_mjpeg_t *p)
+{
+    return p->playing ? lv_tick_elaps(p->clock_base) : p->pause_elapsed;
+}
+
+static uint32_t mjpeg_pts_ms(lv_ameba_mjpeg_t *p, uint32_t seq)
+{
+    return (uint32_t)((uint64_t)seq * p->frame_us / 1000);
+}
+
+static lv_result_t mjpeg_index_add(lv_ameba_mjpeg_t *p, uint32_t offset, uint32_t size)
+{
+    if (p->frame_cnt == p->index_cap) {
+        uint32_t cap = p->index_cap ? p->index_cap * 2 : 64;
+        mjpeg_index_t *index = lv_realloc(p->index, cap * sizeof(mjpeg_index_t));
+        if (index == NULL) {
+            return LV_RESULT_INVALID;
+        }
+        p->index = index;
+        p->index_cap = cap;
+    }
+
+    p->index[p->frame_cnt].offset = offset;
+    p->index[p->frame_cnt].size = size;
+    p->frame_cnt++;
+
+    return LV_RESULT_OK;
+}
+
+static bool mjpeg_read_at(lv_ameba_mjpeg_t *p, uint32_t pos, void *buf, uint32_t len)
+{
+    uint32_t rn = 0;
+
+    if (lv_fs_seek(&p->file, pos, LV_FS_SEEK_SET) != LV_FS_RES_OK) {
+        return false;
+    }
+
+    return lv_fs_read(&p->file, buf, len, &rn) == LV_FS_RES_OK && rn == len;
+}
+
+/*
+ * Walk the RIFF tree flat: descend into the lists that hold the headers and
+ * the 'movi' data, index every '##dc' (compressed) video chunk and skip the
+ * rest. '##db' chunks are uncompressed DIBs the JPEG decoder can't take.
+ */
+static lv_result_t mjpeg_index_avi(lv_ameba_mjpeg_t *p, uint32_t riff_end)
+{
+    uint32_t pos = 12;
+    uint32_t chunk[3];
+
+    while (pos + 8 <= riff_end && mjpeg_read_at(p, pos, chunk, 8)) {
+        uint32_t id = chunk[0];
+        uint32_t size = chunk[1];
+
+        if (id == FOURCC('L', 'I', 'S', 'T')) {
+            if (!mjpeg_read_at(p, pos + 8, &chunk[2], 4)) {
+                break;
+            }
+            if (chunk[2] == FOURCC('h', 'd', 'r', 'l') || chunk[2] == FOURCC('m', 'o', 'v', 'i') ||
+                chunk[2] == FOURCC('r', 'e', 'c', ' ')) {
+                pos += 12;
+                continue;
+            }
+        } else if (id == FOURCC('a', 'v', 'i', 'h')) {
+            /* dwMicroSecPerFrame comes first */
+            if (mjpeg_read_at(p, pos + 8, &chunk[2], 4) && chunk[2]) {
+                p->frame_us = chunk[2];
+            }
+        } else if ((id >> 16) == ('d' | ('c' << 8)) && size) {
+            if (mjpeg_index_add(p, pos + 8, size) != LV_RESULT_OK) {
+                return LV_RESULT_INVALID;
+            }
+        }
+
+        pos += 8 + ((size + 1) & ~1U);
+    }
+
+    return p->frame_cnt ? LV_RESULT_OK : LV_RESULT_INVALID;
+}
+
+/*
+ * Raw MJPEG is a plain concatenation of JPEG files. Markers can't appear in
+ * entropy coded data (0xFF is stuffed), so SOI..EOI delimits each frame.
+ */
+static lv_result_t mjpeg_index_raw(lv_ameba_mjpeg_t *p)
+{
+    uint8_t *chunk = lv_malloc(MJPEG_SCAN_CHUNK);
+    uint32_t pos = 0;
+    uint32_t start = 0;
+    uint32_t rn = 0;
+    bool in_frame = false;
+    uint8_t prev = 0;
+
+    if (chunk == NULL || lv_fs_seek(&p->file, 0, LV_FS_SEEK_SET) != LV_FS_RES_OK) {
+        lv_free(chunk);
+        return LV_RESULT_INVALID;
+    }
+
+    while (lv_fs_read(&p->file, chunk, MJPEG_SCAN_CHUNK, &rn) == LV_FS_RES_OK && rn) {
+        for (uint32_t i = 0; i < rn; i++, pos++) {
+            if (prev == 0xFF) {
+                if (!in_frame && chunk[i] == 0xD8) {
+                    start = pos - 1;
+                    in_frame = true;
+                } else if (in_frame && chunk[i] == 0xD9) {
+                    if (mjpeg_index_add(p, start, pos + 1 - start) != LV_RESULT_OK) {
+                        lv_free(chunk);
+                        return LV_RESULT_INVALID;
+                    }
+                    in_frame = false;
+                }
+            }
+            prev = chunk[i];
+        }
+    }
+
+    lv_free(chunk);
+    p->frame_us = 1000000 / p->fps;
+
+    return p->frame_cnt ? LV_RESULT_OK : LV_RESULT_INVALID;
+}
+
+static lv_result_t mjpeg_load_frame(lv_ameba_mjpeg_t *p, const mjpeg_index_t *idx)
+{
+    if (p->mapped) {
+        p->frame_data = p->mapped + idx->offset;
+        return LV_RESULT_OK;
+    }
+
+    if (idx->size > p->stream_cap) {
+        lv_free(p->stream);
+        p->stream = lv_malloc(idx->size);
+        p->stream_cap = p->stream ? idx->size : 0;
+        if (p->stream == NULL) {
+            return LV_RESULT_INVALID;
+        }
+    }
+
+    if (!mjpeg_read_at(p, idx->offset, p->stream, idx->size)) {
+        return LV_RESULT_INVALID;
+    }
+    DCache_Clean((u32)p->stream, idx->size);
+    p->frame_data = p->stream;
+
+    return LV_RESULT_OK;
+}
+
+/*
+ * Only the buffers stay warm across frames. The decoder + PP are brought up per
+ * frame under the HW lock, so JPEG_RTK decodes can take the hardware in between.
+ */
+static lv_result_t mjpeg_decode_frame(lv_ameba_mjpeg_t *p, uint32_t frame, lv_draw_buf_t *buf)
+{
+    if (mjpeg_load_frame(p, &p->index[frame]) != LV_RESULT_OK) {
+        return LV_RESULT_INVALID;
+    }
+
+    return lv_ameba_jpeg_hw_decode_to(p->frame_data, p->index[frame].size, p->out_w, p->out_h, buf);
+}
+
+static mjpeg_frame_t *mjpeg_get_free_frame(lv_ameba_mjpeg_t *p)
+{
+    for (int i = 0; i < MJPEG_FRAME_BUF_CNT; i++) {
+        if (p->frames[i].state == FRAME_FREE) {
+            return &p->frames[i];
+        }
+    }
+
+    return NULL;
+}
+
+static void mjpeg_task(void *param)
+{
+    lv_ameba_mjpeg_t *p = param;
+
+    /* Frees come from the frame timer, nothing wakes the task while both buffers wait */
+    while (rtos_sema_take(p->free_sema, RTOS_MAX_TIMEOUT) == RTK_SUCCESS && !p->exit) {
+        uint32_t seq = p->seq;
+        if (seq >= p->frame_cnt && !p->loop) {
+            /* End of clip, keep the buffer and sleep until play() or set_loop() */
+            rtos_sema_give(p->free_sema);
+            rtos_sema_take(p->wake_sema, RTOS_MAX_TIMEOUT);
+            continue;
+        }
+
+        /* Skip frames whose successor is already due, the decoder can't catch up with them */
+        while (p->playing && (seq + 1 < p->frame_cnt || p->loop) &&
+               mjpeg_pts_ms(p, seq + 1) <= mjpeg_elapsed_ms(p)) {
+            seq++;
+            p->dropped++;
+        }
+
+        mjpeg_frame_t *f = mjpeg_get_free_frame(p);
+        if (f == NULL) {
+            continue;
+        }
+
+        uint64_t start = rtos_time_get_current_system_time_ns();
+        if (mjpeg_decode_frame(p, seq % p->frame_cnt, f->buf) == LV_RESULT_OK) {
+            f->pts_ms = mjpeg_pts_ms(p, seq);
+            f->seq = seq;
+            f->state = FRAME_READY;
+        } else {
+            /* Broken frame, the previous one stays on screen */
+            p->dropped++;
+            rtos_sema_give(p->free_sema);
+        }
+        p->decode_us = (rtos_time_get_current_system_time_ns() - start) / 1000;
+        p->seq = seq + 1;
+    }
+
+    rtos_sema_give(p->exit_sema);
+    rtos_task_delete(NULL);
+}
+
+static void mjpeg_timer_cb(lv_timer_t *timer)
+{
+    lv_ameba_mjpeg_t *p = lv_timer_get_user_data(timer);
+    uint32_t now = mjpeg_elapsed_ms(p);
+    mjpeg_frame_t *due = NULL;
+
+    for (int i = 0; i < MJPEG_FRAME_BUF_CNT; i++) {
+        mjpeg_frame_t *f = &p->frames[i];
+        if (f->state == FRAME_READY && f->pts_ms <= now && (due == NULL || f->pts_ms > due->pts_ms)) {
+            due = f;
+        }
+    }
+
+    if (due == NULL) {
+        return;
+    }
+
+    for (int i = 0; i < MJPEG_FRAME_BUF_CNT; i++) {
+        mjpeg_frame_t *f = &p->frames[i];
+        if (f == due) {
+            continue;
+        }
+        if (f->state == FRAME_READY && f->pts_ms < due->pts_ms) {
+            p->dropped++;
+        } else if (f->state != FRAME_SHOWN) {
+            continue;
+        }
+        f->state = FRAME_FREE;
+        rtos_sema_give(p->free_sema);
+    }
+
+    due->state = FRAME_SHOWN;
+    lv_image_set_src(p->img, &due->dsc);
+    p->shown++;
+
+    /* Stop the clock on the last frame so play() starts the clip over */
+    if (!p->loop && due->seq + 1 >= p->frame_cnt) {
+        p->pause_elapsed = now;
+        p->playing = false;
+    }
+
+#if MJPEG_DEBUG
+    printf("mjpeg pts %lu at %lu, decode %lu us, dropped %lu\n", due->pts_ms, now, p->decode_us, p->dropped);
+#endif
+}
+
+static void mjpeg_release(lv_ameba_mjpeg_t *p)
+{
+    if (p->task_running) {
+        p->exit = true;
+        rtos_sema_give(p->free_sema);
+        rtos_sema_give(p->wake_sema);
+        rtos_sema_take(p->exit_sema, RTOS_MAX_TIMEOUT);
+        p->task_running = false;
+    }
+
+    if (p->timer) {
+        lv_timer_delete(p->timer);
+        p->timer = NULL;
+    }
+
+    for (int i = 0; i < MJPEG_FRAME_BUF_CNT; i++) {
+        if (p->frames[i].buf) {
+            lv_draw_buf_destroy(p->frames[i].buf);
+            p->frames[i].buf = NULL;
+        }
+    }
+
+    if (p->file_open) {
+        lv_fs_close(&p->file);
+        p->file_open = false;
+        p->mapped = NULL;
+    }
+
+    lv_free(p->index);
+    lv_free(p->stream);
+    p->index = NULL;
+    p->stream = NULL;
+    p->frame_cnt = 0;
+    p->index_cap = 0;
+    p->stream_cap = 0;
+
+    if (p->free_sema) {
+        rtos_sema_delete(p->free_sema);
+        p->free_sema = NULL;
+    }
+    if (p->wake_sema) {
+        rtos_sema_delete(p->wake_sema);
+        p->wake_sema = NULL;
+    }
+    if (p->exit_sema) {
+        rtos_sema_delete(p->exit_sema);
+        p->exit_sema = NULL;
+    }
+}
+
+static void mjpeg_delete_event_cb(lv_event_t *e)
+{
+    lv_ameba_mjpeg_t *p = lv_event_get_user_data(e);
+
+    mjpeg_release(p);
+    lv_free(p);
+}
+
+/* Size the output from the first frame, checked against the PP limits like every JPEG_RTK decode */
+static lv_result_t mjpeg_setup_size(lv_ameba_mjpeg_t *p)
+{
+    if (mjpeg_load_frame(p, &p->index[0]) != LV_RESULT_OK) {
+        return LV_RESULT_INVALID;
+    }
+
+    if (lv_ameba_jpeg_hw_out_size(p->frame_data, p->index[0].size, &p->out_w, &p->out_h) != LV_RESULT_OK) {
+        printf("Error: the HW can't decode the clip to %ux%u.\n", p->out_w, p->out_h);
+        return LV_RESULT_INVALID;
+    }
+
+    return LV_RESULT_OK;
+}
+
+lv_ameba_mjpeg_t *lv_ameba_mjpeg_create(lv_obj_t *parent)
+{
+    lv_ameba_mjpeg_t *p = lv_malloc_zeroed(sizeof(lv_ameba_mjpeg_t));
+    if (p == NULL) {
+        return NULL;
+    }
+
+    p->img = lv_image_create(parent);
+    if (p->img == NULL) {
+        lv_free(p);
+        return NULL;
+    }
+
+    p->fps = LV_AMEBA_MJPEG_DEFAULT_FPS;
+    lv_obj_add_event_cb(p->img, mjpeg_delete_event_cb, LV_EVENT_DELETE, p);
+
+    return p;
+}
+
+lv_obj_t *lv_ameba_mjpeg_get_obj(lv_ameba_mjpeg_t *player)
+{
+    return player->img;
+}
+
+void lv_ameba_mjpeg_set_output_size(lv_ameba_mjpeg_t *player, uint16_t w, uint16_t h)
+{
+    player->out_w = (w + LV_AMEBA_JPEG_OUT_W_ALIGN - 1) & ~(LV_AMEBA_JPEG_OUT_W_ALIGN - 1);
+    player->out_h = (h + LV_AMEBA_JPEG_OUT_H_ALIGN - 1) & ~(LV_AMEBA_JPEG_OUT_H_ALIGN - 1);
+}
+
+void lv_ameba_mjpeg_set_fps(lv_ameba_mjpeg_t *player, uint32_t fps)
+{
+    player->fps = fps ? fps : LV_AMEBA_MJPEG_DEFAULT_FPS;
+}
+
+lv_result_t lv_ameba_mjpeg_open(lv_ameba_mjpeg_t *player, const char *path)
+{
+    lv_ameba_mjpeg_t *p = player;
+    uint32_t riff[3];
+    lv_result_t res;
+
+    if (p->file_open) {
+        LV_LOG_WARN("mjpeg player already has a clip");
+        return LV_RESULT_INVALID;
+    }
+
+    if (lv_fs_open(&p->file, path, LV_FS_MODE_RD) != LV_FS_RES_OK) {
+        LV_LOG_WARN("can't open %s", path);
+        return LV_RESULT_INVALID;
+    }
+    p->file_open = true;
+
+    uint32_t mapped_size;
+    if (lv_fs_romfs_map_file(&p->file, (const void **)&p->mapped, &mapped_size) != LV_RESULT_OK) {
+        p->mapped = NULL;
+    }
+
+    if (mjpeg_read_at(p, 0, riff, sizeof(riff)) &&
+        riff[0] == FOURCC('R', 'I', 'F', 'F') && riff[2] == FOURCC('A', 'V', 'I', ' ')) {
+        p->frame_us = 1000000 / p->fps;
+        res = mjpeg_index_avi(p, riff[1] + 8);
+    } else {
+        res = mjpeg_index_raw(p);
+    }
+
+    if (res != LV_RESULT_OK) {
+        LV_LOG_WARN("no frames in %s", path);
+        goto failed;
+    }
+
+    if (mjpeg_setup_size(p) != LV_RESULT_OK) {
+        goto failed;
+    }
+
+    lv_color_format_t cf = lv_ameba_jpeg_lv_out_format();
+    uint32_t stride = lv_draw_buf_width_to_stride(p->out_w, cf);
+    for (int i = 0; i < MJPEG_FRAME_BUF_CNT; i++) {
+        mjpeg_frame_t *f = &p->frames[i];
+        f->buf = lv_draw_buf_create(p->out_w, p->out_h, cf, stride);
+        if (f->buf == NULL) {
+            printf("mjpeg frame buffer create failed.\n");
+            goto failed;
+        }
+        lv_memzero(&f->dsc, sizeof(f->dsc));
+        f->dsc.header = f->buf->header;
+        f->dsc.header.flags = 0;
+        f->dsc.data = f->buf->data;
+        f->dsc.data_size = f->buf->data_size;
+        f->state = FRAME_FREE;
+    }
+
+    rtos_sema_create(&p->free_sema, MJPEG_FRAME_BUF_CNT, MJPEG_FRAME_BUF_CNT);
+    rtos_sema_create(&p->wake_sema, 0, 1);
+    rtos_sema_create(&p->exit_sema, 0, 1);
+
+    p->seq = 0;
+    p->pause_elapsed = 0;
+    p->exit = false;
+    if (rtos_task_create(NULL, "mjpeg_dec", mjpeg_task, p,
+                         LV_AMEBA_MJPEG_TASK_STACK_SIZE, LV_AMEBA_MJPEG_TASK_PRIO) != RTK_SUCCESS) {
+        printf("Error: mjpeg task create failed.\n");
+        goto failed;
+    }
+    p->task_running = true;
+
+    /* Poll at twice the frame rate so a frame is never shown more than half a period late */
+    p->timer = lv_timer_create(mjpeg_timer_cb, LV_MAX(p->frame_us / 2000, 1), p);
+    lv_obj_set_size(p->img, p->out_w, p->out_h);
+
+    return LV_RESULT_OK;
+
+failed:
+    mjpeg_release(p);
+    return LV_RESULT_INVALID;
+}
+
+void lv_ameba_mjpeg_play(lv_ameba_mjpeg_t *player)
+{
+    lv_ameba_mjpeg_t *p = player;
+
+    if (p->playing || !p->task_running) {
+        return;
+    }
+
+    /* Restart a clip that played to its end */
+    if (p->seq >= p->frame_cnt && !p->loop) {
+        p->seq = 0;
+        p->pause_elapsed = 0;
+    }
+
+    p->clock_base = lv_tick_get() - p->pause_elapsed;
+    p->playing = true;
+    rtos_sema_give(p->wake_sema);
+}
+
+void lv_ameba_mjpeg_pause(lv_ameba_mjpeg_t *player)
+{
+    lv_ameba_mjpeg_t *p = player;
+
+    if (!p->playing) {
+        return;
+    }
+
+    p->pause_elapsed = lv_tick_elaps(p->clock_base);
+    p->playing = false;
+}
+
+void lv_ameba_mjpeg_set_loop(lv_ameba_mjpeg_t *player, bool loop)
+{
+    player->loop = loop;
+    if (loop && player->wake_sema) {
+        rtos_sema_give(player->wake_sema);
+    }
+}
+
+void lv_ameba_mjpeg_get_stats(lv_ameba_mjpeg_t *player, lv_ameba_mjpeg_stats_t *stats)
+{
+    stats->frames = player->frame_cnt;
+    stats->shown = player->shown;
+    stats->dropped = player->dropped;
+    stats->decode_us = player->decode_us;
+    stats->frame_us = player->frame_us;
+}
@@ -20,6 +20,8 @@
 #include "lvgl.h"
 #include "lv_draw_ppe.h"
 
+#include "display_mode_setting.h"
+
 #include "src/misc/lv_types.h"
 #include "src/draw/lv_draw.h"
 #include "src/draw/lv_draw_private.h"
@@ -46,6 +48,10 @@
 #define DRAW_UNIT_ID_PPE            4
 #define PPE_BLOCK_ALIGN             16  // PP works best with 16x16 blocks
 
+// back off while the LCDC underflows with its DMA burst already maxed out
+#define PPE_THROTTLE_ON_UNDERFLOW   1
+#define PPE_THROTTLE_DELAY_MS       1
+
 typedef struct {
     lv_draw_unit_t base_unit;
     lv_draw_task_t *task_act;
@@ -599,6 +605,11 @@ static void _ppe_draw_mask_rect(lv_draw_task_t *t)
 }
 
 void lv_draw_ppe_configure_and_start_transfer(lv_draw_ppe_configuration_t *ppe_draw_conf) {
+#if PPE_THROTTLE_ON_UNDERFLOW
+    if (display_mode_is_congested()) {
+        rtos_time_delay_ms(PPE_THROTTLE_DELAY_MS);
+    }
+#endif
     rtos_sema_take(g_ppe_ctx->trans_sema, RTOS_MAX_TIMEOUT);
     uint8_t input_layer_id = PPE_INPUT_LAYER1_INDEX;
     PPE_InputLayer_InitTypeDef Input_Layer;
@@ -0,0 +1,143 @@
+/*
+ * Copyright (c) 2026 Realtek Semiconductor Corp.
+ * All rights reserved.
+ *
+ * Licensed under the Realtek License, Version 1.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License from Realtek
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef AMEBA_UI_LVGL_HAL_INCLUDE_AMEBAGREEN2_LV_AMEBA_IMG_CACHE_H
+#define AMEBA_UI_LVGL_HAL_INCLUDE_AMEBAGREEN2_LV_AMEBA_IMG_CACHE_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*********************
+ *      INCLUDES
+ *********************/
+
+#include "lvgl.h"
+
+/*********************
+ *      DEFINES
+ *********************/
+
+/* Default byte budget of decoded images kept after `decoder_close_cb` */
+#ifndef LV_AMEBA_IMG_CACHE_SIZE
+    #define LV_AMEBA_IMG_CACHE_SIZE     (4 * 1024 * 1024)
+#endif
+
+/**********************
+ * GLOBAL PROTOTYPES
+ **********************/
+
+/**
+ * Identifies one decoded result: the same source decoded with different
+ * output size or crop window gives different entries.
+ */
+typedef struct {
+    lv_image_src_t src_type;    /**< LV_IMAGE_SRC_FILE: `src` is a path, else the address of the encoded data */
+    const void *src;
+    /* Variable sources only: the descriptor, so data put at a reused address doesn't match */
+    uint32_t data_size;
+    lv_image_header_t header;
+    uint16_t out_w;             /**< Requested output size, 0 for the source size */
+    uint16_t out_h;
+    uint16_t crop_x;            /**< Source window, crop_w/crop_h 0 for the whole image */
+    uint16_t crop_y;
+    uint16_t crop_w;
+    uint16_t crop_h;
+} lv_ameba_img_cache_key_t;
+
+typedef struct {
+    uint32_t hits;
+    uint32_t misses;
+    uint32_t evictions;
+    uint32_t entries;
+    uint32_t pinned;
+    size_t used_bytes;
+    size_t budget_bytes;
+} lv_ameba_img_cache_stats_t;
+
+/**
+ * @brief Initialize the decoded-image cache with `LV_AMEBA_IMG_CACHE_SIZE` bytes.
+ * Also registers a decoder in front of all others that serves cached images of any format.
+ */
+void lv_ameba_img_cache_init(void);
+
+/**
+ * @brief Drop every unused entry and free the cache
+ */
+void lv_ameba_img_cache_deinit(void);
+
+/**
+ * @brief Change the byte budget, evicting unused entries down to it
+ */
+void lv_ameba_img_cache_set_budget(size_t bytes);
+
+/**
+ * @brief Build the cache key of an image source as passed to `lv_image_set_src()`
+ */
+void lv_ameba_img_cache_key_init(lv_ameba_img_cache_key_t *key, const void *src);
+
+/**
+ * @brief Whether two keys name the same decoded result
+ */
+bool lv_ameba_img_cache_key_equal(const lv_ameba_img_cache_key_t *a, const lv_ameba_img_cache_key_t *b);
+
+/**
+ * @brief Look up a decoded image and take a reference on it
+ * @return the cached buffer or NULL on a miss, give it back with `lv_ameba_img_cache_release()`
+ */
+lv_draw_buf_t *lv_ameba_img_cache_acquire(const lv_ameba_img_cache_key_t *key);
+
+/**
+ * @brief Check for a decoded image without taking a reference or counting a hit
+ */
+bool lv_ameba_img_cache_contains(const lv_ameba_img_cache_key_t *key);
+
+/**
+ * @brief Hand a decoded image over to the cache
+ * @param acquire   also take a reference, as if `lv_ameba_img_cache_acquire()` was called
+ * @return LV_RESULT_OK if the cache owns `buf` now, LV_RESULT_INVALID if it doesn't fit the budget
+ */
+lv_result_t lv_ameba_img_cache_add(const lv_ameba_img_cache_key_t *key, lv_draw_buf_t *buf, bool acquire);
+
+/**
+ * @brief Drop a reference taken on a cached buffer
+ * @return false if `buf` isn't owned by the cache and must be destroyed by the caller
+ */
+bool lv_ameba_img_cache_release(const lv_draw_buf_t *buf);
+
+/**
+ * @brief Keep (or stop keeping) every decoded variant of `src` resident, e.g. for images on screen
+ * @return LV_RESULT_INVALID if `src` has not been decoded into the cache yet
+ */
+lv_result_t lv_ameba_img_cache_pin(const void *src, bool pin);
+
+/**
+ * @brief Forget every unused decoded variant of `src`, e.g. after the file changed
+ */
+void lv_ameba_img_cache_drop(const void *src);
+
+/**
+ * @brief Evict unused entries until `bytes` could be allocated within the budget
+ * @return number of bytes freed
+ */
+size_t lv_ameba_img_cache_reclaim(size_t bytes);
+
+void lv_ameba_img_cache_get_stats(lv_ameba_img_cache_stats_t *stats);
+
+#ifdef __cplusplus
+} /*extern "C"*/
+#endif
+
+#endif /* AMEBA_UI_LVGL_HAL_INCLUDE_AMEBAGREEN2_LV_AMEBA_IMG_CACHE_H */
@@ -0,0 +1,84 @@
+/*
+ * Copyright (c) 2026 Realtek Semiconductor Corp.
+ * All rights reserved.
+ *
+ * Licensed under the Realtek License, Version 1.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License from Realtek
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef AMEBA_UI_LVGL_HAL_INCLUDE_AMEBAGREEN2_LV_AMEBA_IMG_PREFETCH_H
+#define AMEBA_UI_LVGL_HAL_INCLUDE_AMEBAGREEN2_LV_AMEBA_IMG_PREFETCH_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*********************
+ *      INCLUDES
+ *********************/
+
+#include "lvgl.h"
+
+/*********************
+ *      DEFINES
+ *********************/
+
+/* Sources that can wait for the prefetch task */
+#ifndef LV_AMEBA_IMG_PREFETCH_QUEUE_LEN
+    #define LV_AMEBA_IMG_PREFETCH_QUEUE_LEN     16
+#endif
+
+/*
+ * Level with the LVGL task (priority 1) so the two share the CPU in time slices.
+ * 0 is the idle task's priority, prefetching there would starve behind any busy task.
+ */
+#ifndef LV_AMEBA_IMG_PREFETCH_PRIO
+    #define LV_AMEBA_IMG_PREFETCH_PRIO          1
+#endif
+
+#ifndef LV_AMEBA_IMG_PREFETCH_STACK_SIZE
+    #define LV_AMEBA_IMG_PREFETCH_STACK_SIZE    (8 * 1024)
+#endif
+
+/**********************
+ * GLOBAL PROTOTYPES
+ **********************/
+
+/**
+ * @brief Called on the prefetch task once a source has been handled
+ * @param res   LV_RESULT_OK if the decoded image is in the cache now
+ */
+typedef void (*lv_ameba_img_prefetch_cb_t)(const void *src, lv_result_t res, void *user_data);
+
+/**
+ * @brief Start the prefetch task, requires `lv_ameba_img_cache_init()`
+ */
+void lv_ameba_img_prefetch_init(void);
+
+/**
+ * @brief Queue an image source for background decoding into the decoded-image cache.
+ * JPEGs use the HW decoder without blocking LVGL, other formats are decoded by
+ * the registered LVGL decoders with the LVGL lock held.
+ * @param src   as passed to `lv_image_set_src()`, must stay valid until handled
+ * @param cb    optional completion callback, NULL if not needed
+ * @return LV_RESULT_INVALID if the queue is full
+ */
+lv_result_t lv_ameba_img_prefetch(const void *src, lv_ameba_img_prefetch_cb_t cb, void *user_data);
+
+/**
+ * @brief Forget every queued source that hasn't been started yet, e.g. when leaving a page
+ */
+void lv_ameba_img_prefetch_cancel_all(void);
+
+#ifdef __cplusplus
+} /*extern "C"*/
+#endif
+
+#endif /* AMEBA_UI_LVGL_HAL_INCLUDE_AMEBAGREEN2_LV_AMEBA_IMG_PREFETCH_H */
@@ -20,12 +20,127 @@
 extern "C" {
 #endif
 
+#include "lvgl.h"
+
+/* Set in `header.flags` of a `lv_ameba_jpeg_src_t` to request a scaled/cropped decode */
+#define LV_AMEBA_JPEG_FLAG_SCALED       LV_IMAGE_FLAGS_USER1
+
+/* Set by JPEG_RTK in the image header when libjpeg-turbo decodes a scaled source the HW can't */
+#define LV_AMEBA_JPEG_FLAG_TURBO        LV_IMAGE_FLAGS_USER2
+
+/* Image sizes the HW decoder takes, others go to libjpeg-turbo */
+#ifndef LV_AMEBA_JPEG_HW_MIN_SIZE
+    #define LV_AMEBA_JPEG_HW_MIN_SIZE       48
+#endif
+
+#ifndef LV_AMEBA_JPEG_HW_MAX_SIZE
+    #define LV_AMEBA_JPEG_HW_MAX_SIZE       8176
+#endif
+
+/* PP output width must be a multiple of 8 and height a multiple of 2 */
+#define LV_AMEBA_JPEG_OUT_W_ALIGN       8
+#define LV_AMEBA_JPEG_OUT_H_ALIGN       2
+
+/* PP crop origin must be a multiple of 16, crop size a multiple of 8 */
+#define LV_AMEBA_JPEG_CROP_POS_ALIGN    16
+#define LV_AMEBA_JPEG_CROP_SIZE_ALIGN   8
+
+/*
+ * Images that decode to more than this are streamed through libjpeg-turbo in
+ * bands of rows, only where they are drawn. Needs LV_USE_LIBJPEG_TURBO.
+ */
+#ifndef LV_AMEBA_JPEG_TILED_MIN_SIZE
+    #define LV_AMEBA_JPEG_TILED_MIN_SIZE    (2 * 1024 * 1024)
+#endif
+
+/* Bytes per band, the rows follow from the width being drawn */
+#ifndef LV_AMEBA_JPEG_TILE_SIZE
+    #define LV_AMEBA_JPEG_TILE_SIZE         (512 * 1024)
+#endif
+
+/* Decoded bands kept for redraws, apart from the decoded-image cache */
+#ifndef LV_AMEBA_JPEG_TILE_POOL_CNT
+    #define LV_AMEBA_JPEG_TILE_POOL_CNT     4
+#endif
+
+/**
+ * Image source that lets the HW decoder scale and crop a JPEG straight to the
+ * size it is displayed at, so only a target-size buffer is allocated.
+ * Pass it to `lv_image_set_src()`; it must stay valid while the image uses it.
+ */
+typedef struct {
+    lv_image_dsc_t dsc;         /**< Must be first. `header` holds the output size (0 for the window size),
+                                     `data` the JPEG stream */
+    const char *path;           /**< JPEG file to decode when `dsc.data` is NULL */
+    /**
+     * Source window to scale from, crop_w/crop_h 0 for the whole image. The PP
+     * needs an aligned window, so the origin is rounded down to
+     * LV_AMEBA_JPEG_CROP_POS_ALIGN and the size widened to cover the request in
+     * LV_AMEBA_JPEG_CROP_SIZE_ALIGN steps, clipped to the image padded to whole
+     * 16 pixel MCUs. The output shows that aligned window on both the HW and the
+     * libjpeg-turbo fallback, pass aligned values to get exactly the one asked for.
+     */
+    uint16_t crop_x;
+    uint16_t crop_y;
+    uint16_t crop_w;
+    uint16_t crop_h;
+} lv_ameba_jpeg_src_t;
+
+typedef enum {
+    LV_AMEBA_JPEG_BACKEND_HW,                   /**< JPEG decoder + PP */
+    LV_AMEBA_JPEG_BACKEND_LIBJPEG_TURBO,        /**< Left to LVGL's libjpeg-turbo decoder */
+    LV_AMEBA_JPEG_BACKEND_LIBJPEG_TURBO_SCALED, /**< libjpeg-turbo with DCT-domain downscaling */
+    LV_AMEBA_JPEG_BACKEND_CNT,
+} lv_ameba_jpeg_backend_t;
+
+typedef struct {
+    uint32_t decodes[LV_AMEBA_JPEG_BACKEND_CNT];  /**< Images decoded here by each backend,
+                                                       LIBJPEG_TURBO ones are decoded by LVGL and not counted */
+    uint32_t declined;          /**< Info requests handed on to LVGL's libjpeg-turbo decoder,
+                                     LVGL asks several times per image so this is no image count */
+    uint32_t failed;
+    lv_ameba_jpeg_backend_t last_backend;
+    bool simd;                  /**< libjpeg-turbo is built with the NEON routines */
+} lv_ameba_jpeg_stats_t;
+
 /**
  * Register ameba jpeg decoder functions in LVGL
  */
 void lv_ameba_jpeg_init(void);
 void lv_ameba_jpeg_deinit(void);
 
+/**
+ * Decode a JPEG image source with the HW decoder outside of the LVGL draw path.
+ * Safe to call from any task, the decoder hardware is serialized internally.
+ * @param src   file path, `lv_image_dsc_t` or `lv_ameba_jpeg_src_t`
+ * @param out   the decoded buffer, owned by the caller
+ * @return LV_RESULT_INVALID if `src` is not a JPEG or the HW can't decode it
+ */
+lv_result_t lv_ameba_jpeg_decode_src(const void *src, lv_draw_buf_t **out);
+
+/**
+ * Which backend decoded how many images, and how often images were left to LVGL
+ */
+void lv_ameba_jpeg_get_stats(lv_ameba_jpeg_stats_t *stats);
+
+/**
+ * Describe a JPEG file to be decoded to `out_w` x `out_h`.
+ * The output size is rounded up to the PP alignment, 0 keeps the size of the
+ * source window in that direction.
+ * @param crop  source window in JPEG pixels, NULL for the whole image.
+ *              Parts left of or above the image are clipped off.
+ * @return LV_RESULT_INVALID if `crop` lies entirely outside the image
+ */
+lv_result_t lv_ameba_jpeg_src_init_file(lv_ameba_jpeg_src_t *src, const char *path,
+                                        uint16_t out_w, uint16_t out_h, const lv_area_t *crop);
+
+/**
+ * Describe a JPEG stream in memory to be decoded to `out_w` x `out_h`.
+ * Sizes and `crop` as for `lv_ameba_jpeg_src_init_file()`.
+ */
+lv_result_t lv_ameba_jpeg_src_init_data(lv_ameba_jpeg_src_t *src, const void *data, uint32_t data_size,
+                                        uint16_t out_w, uint16_t out_h, const lv_area_t *crop);
+
 #ifdef __cplusplus
 }
 #endif
@@ -0,0 +1,55 @@
+/*
+ * Copyright (c) 2026 Realtek Semiconductor Corp.
+ * All rights reserved.
+ *
+ * Licensed under the Realtek License, Version 1.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License from Realtek
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef AMEBA_UI_LVGL_HAL_INCLUDE_AMEBAGREEN2_LV_AMEBA_JPEG_PRIVATE_H
+#define AMEBA_UI_LVGL_HAL_INCLUDE_AMEBAGREEN2_LV_AMEBA_JPEG_PRIVATE_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include "lv_ameba_jpeg.h"
+
+/*
+ * Shared by the HAL modules that drive the JPEG decoder and PP themselves.
+ * Not meant for applications.
+ */
+
+/**
+ * Size a HW decode of a JPEG stream to `out_w` x `out_h` gives, 0 keeps the source size.
+ * @param out_w, out_h  the request in, the PP output size out
+ * @return LV_RESULT_INVALID if the HW or the PP can't take the stream at that size
+ */
+lv_result_t lv_ameba_jpeg_hw_out_size(const uint8_t *data, uint32_t size, uint16_t *out_w, uint16_t *out_h);
+
+/**
+ * Decode a JPEG stream with the HW into `buf`, which must have the size
+ * `lv_ameba_jpeg_hw_out_size()` gives for `out_w` x `out_h`.
+ * The decoder + PP are brought up for this decode only, under the lock every
+ * other HW decode takes, so it is safe from any task.
+ */
+lv_result_t lv_ameba_jpeg_hw_decode_to(const uint8_t *data, uint32_t size, uint16_t out_w, uint16_t out_h,
+                                       lv_draw_buf_t *buf);
+
+/**
+ * LVGL color format the PP outputs for `LV_COLOR_DEPTH`
+ */
+lv_color_format_t lv_ameba_jpeg_lv_out_format(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* AMEBA_UI_LVGL_HAL_INCLUDE_AMEBAGREEN2_LV_AMEBA_JPEG_PRIVATE_H */
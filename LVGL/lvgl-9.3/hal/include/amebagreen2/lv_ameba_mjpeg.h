@@ -0,0 +1,98 @@
+/*
+ * Copyright (c) 2026 Realtek Semiconductor Corp.
+ * All rights reserved.
+ *
+ * Licensed under the Realtek License, Version 1.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License from Realtek
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef AMEBA_UI_LVGL_HAL_INCLUDE_AMEBAGREEN2_LV_AMEBA_MJPEG_H
+#define AMEBA_UI_LVGL_HAL_INCLUDE_AMEBAGREEN2_LV_AMEBA_MJPEG_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*********************
+ *      INCLUDES
+ *********************/
+
+#include "lvgl.h"
+
+/*********************
+ *      DEFINES
+ *********************/
+
+/* Frame rate of raw concatenated JPEG streams, AVI files carry their own */
+#ifndef LV_AMEBA_MJPEG_DEFAULT_FPS
+    #define LV_AMEBA_MJPEG_DEFAULT_FPS      30
+#endif
+
+/* Above the LVGL task so the next frame is ready before it is due */
+#ifndef LV_AMEBA_MJPEG_TASK_PRIO
+    #define LV_AMEBA_MJPEG_TASK_PRIO        2
+#endif
+
+#ifndef LV_AMEBA_MJPEG_TASK_STACK_SIZE
+    #define LV_AMEBA_MJPEG_TASK_STACK_SIZE  (4 * 1024)
+#endif
+
+/**********************
+ * GLOBAL PROTOTYPES
+ **********************/
+
+typedef struct _lv_ameba_mjpeg_t lv_ameba_mjpeg_t;
+
+typedef struct {
+    uint32_t frames;            /**< Frames in the clip */
+    uint32_t shown;             /**< Frames displayed since open */
+    uint32_t dropped;           /**< Frames skipped to keep up with the clip timing */
+    uint32_t decode_us;         /**< Decode time of the last frame */
+    uint32_t frame_us;          /**< Frame period from the container */
+} lv_ameba_mjpeg_stats_t;
+
+/**
+ * @brief Create a player showing its frames on a new image object of `parent`.
+ * The player is deleted together with the image object.
+ */
+lv_ameba_mjpeg_t *lv_ameba_mjpeg_create(lv_obj_t *parent);
+
+/**
+ * @brief The image object the frames are shown on, to position or style it
+ */
+lv_obj_t *lv_ameba_mjpeg_get_obj(lv_ameba_mjpeg_t *player);
+
+/**
+ * @brief Scale frames to `w` x `h` with the PP instead of the clip size, call before open
+ */
+void lv_ameba_mjpeg_set_output_size(lv_ameba_mjpeg_t *player, uint16_t w, uint16_t h);
+
+/**
+ * @brief Open an AVI (MJPEG video stream) or a raw concatenation of JPEG frames
+ * @param path  any LVGL file system path, e.g. on romfs
+ */
+lv_result_t lv_ameba_mjpeg_open(lv_ameba_mjpeg_t *player, const char *path);
+
+void lv_ameba_mjpeg_play(lv_ameba_mjpeg_t *player);
+void lv_ameba_mjpeg_pause(lv_ameba_mjpeg_t *player);
+void lv_ameba_mjpeg_set_loop(lv_ameba_mjpeg_t *player, bool loop);
+
+/**
+ * @brief Frame rate for raw JPEG streams without timing, call before open
+ */
+void lv_ameba_mjpeg_set_fps(lv_ameba_mjpeg_t *player, uint32_t fps);
+
+void lv_ameba_mjpeg_get_stats(lv_ameba_mjpeg_t *player, lv_ameba_mjpeg_stats_t *stats);
+
+#ifdef __cplusplus
+} /*extern "C"*/
+#endif
+
+#endif /* AMEBA_UI_LVGL_HAL_INCLUDE_AMEBAGREEN2_LV_AMEBA_MJPEG_H */
@@ -34,9 +34,6 @@
   */
 #define FILEP2FD(file_p) ((lv_uintptr_t)file_p - 1)
 #define FD2FILEP(fd) ((void *)(lv_uintptr_t)(fd + 1))
-#define DT_UNKNOWN           0x00
-#define DT_REG               0x01
-#define DT_DIR               0x02
 
 #define ROM_FS_ADDR          0x08400000
 
@@ -83,7 +80,7 @@ void lv_fs_romfs_init(void)
     lv_fs_drv_t * fs_drv_p = &romfs_fs_drv;
     lv_fs_drv_init(fs_drv_p);
 
-    romfs_mount((void *)ROM_FS_ADDR);
+    lv_fs_romfs_mount();
 
     /*Set up fields...*/
     fs_drv_p->letter = LV_USE_FS_ROMFS_LETTER;
@@ -102,6 +99,62 @@ void lv_fs_romfs_init(void)
     lv_fs_drv_register(fs_drv_p);
 }
 
+void lv_fs_romfs_mount(void)
+{
+    romfs_mount((void *)ROM_FS_ADDR);
+}
+
+lv_result_t lv_fs_romfs_map(const char * path, const void ** data, uint32_t * size)
+{
+    if(path == NULL || path[0] != LV_USE_FS_ROMFS_LETTER || path[1] != ':') return LV_RESULT_INVALID;
+
+    int fd = r_open(path + 2, O_RDONLY);
+    if(fd < 0) return LV_RESULT_INVALID;
+
+    size_t len = 0;
+    *data = r_mmap(fd, &len);
+    *size = (uint32_t)len;
+    r_close(fd);
+
+    return *data ? LV_RESULT_OK : LV_RESULT_INVALID;
+}
+
+lv_result_t lv_fs_romfs_map_file(lv_fs_file_t * file, const void ** data, uint32_t * size)
+{
+    if(file == NULL || file->drv != &romfs_fs_drv || file->file_d == NULL) return LV_RESULT_INVALID;
+
+    size_t len = 0;
+    *data = r_mmap(FILEP2FD(file->file_d), &len);
+    *size = (uint32_t)len;
+
+    return *data ? LV_RESULT_OK : LV_RESULT_INVALID;
+}
+
+lv_result_t lv_fs_romfs_load_image_dsc(const char * path, lv_image_dsc_t * dsc)
+{
+    const uint8_t * data;
+    uint32_t size;
+
+    if(lv_fs_romfs_map(path, (const void **)&data, &size) != LV_RESULT_OK) return LV_RESULT_INVALID;
+
+    lv_memzero(dsc, sizeof(*dsc));
+
+    const lv_image_header_t * header = (const lv_image_header_t *)data;
+    if(size > sizeof(lv_image_header_t) && header->magic == LV_IMAGE_HEADER_MAGIC) {
+        dsc->header = *header;
+        dsc->data = data + sizeof(lv_image_header_t);
+        dsc->data_size = size - sizeof(lv_image_header_t);
+    }
+    else {
+        dsc->header.magic = LV_IMAGE_HEADER_MAGIC;
+        dsc->header.cf = LV_COLOR_FORMAT_RAW;
+        dsc->data = data;
+        dsc->data_size = size;
+    }
+
+    return LV_RESULT_OK;
+}
+
 /**********************
  *   STATIC FUNCTIONS
  **********************/
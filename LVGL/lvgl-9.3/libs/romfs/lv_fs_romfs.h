@@ -20,8 +20,40 @@
 extern "C" {
 #endif
 
+#include "lvgl.h"
+
 void lv_fs_romfs_init(void);
 
+/**
+ * Mount the romfs image at ROM_FS_ADDR without registering the LVGL driver,
+ * for reads before `lv_init()` such as the boot splash. `lv_fs_romfs_init()` does it too.
+ */
+void lv_fs_romfs_mount(void);
+
+/**
+ * Get a romfs file in place instead of reading it into RAM, e.g. to hand a
+ * TTF to `lv_tiny_ttf_create_data()` or a font to `lv_binfont_create_from_buffer()`
+ * @param path  path on the romfs drive, e.g. "A:/img/bg.jpg"
+ * @param data  the file data inside the romfs image, stays valid while it's mounted
+ * @param size  the file size
+ * @return LV_RESULT_INVALID if path isn't a file on the romfs drive
+ */
+lv_result_t lv_fs_romfs_map(const char *path, const void **data, uint32_t *size);
+
+/**
+ * Same as `lv_fs_romfs_map()` for a file opened with `lv_fs_open()`
+ */
+lv_result_t lv_fs_romfs_map_file(lv_fs_file_t *file, const void **data, uint32_t *size);
+
+/**
+ * Describe a romfs image file as a variable source, so it's drawn or decoded
+ * straight from flash. LVGL binary images (.bin) get their header and pixel
+ * data, other files (JPEG, PNG, ...) are passed whole as LV_COLOR_FORMAT_RAW.
+ * @param path  path on the romfs drive
+ * @param dsc   descriptor to fill, pass it to `lv_image_set_src()`
+ */
+lv_result_t lv_fs_romfs_load_image_dsc(const char *path, lv_image_dsc_t *dsc);
+
 #ifdef __cplusplus
 }
 #endif
@@ -2,8 +2,14 @@
 #include "romfs.h"
 //#include "trace.h"
 #include "stdarg.h"
-#include "log.h"
 #include <stdio.h>
+#ifndef ROMFS_HOST
+#include "log.h"
+#include "os_wrapper.h"
+#endif
+#ifdef CONFIG_ZLIB_ENABLE
+#include "zlib.h"
+#endif
 
 #define O_RDONLY         00
 #define O_WRONLY         01
@@ -73,12 +79,8 @@
 #define SEEK_CUR 1 /* current position in stream (see fseek) */
 #define SEEK_END 2 /* end of stream (see fseek) */
 
-#define ROMFS_DIRENT_FILE   0x00
-#define ROMFS_DIRENT_DIR    0x01
+#define ROMFS_DIRENT_IS_DIR(d)  (((d)->type & ROMFS_DIRENT_TYPE_MASK) == ROMFS_DIRENT_DIR)
 
-#define DT_UNKNOWN           0x00
-#define DT_REG               0x01
-#define DT_DIR               0x02
 #define ESUCCESS     0  /* Operation Success */
 
 #define EPERM        1  /* Operation not permitted */
@@ -132,17 +134,89 @@
 #define ENOTSUPP        524     /* Operation is not supported */
 
 // default romfs address
-static void *romfs_addr = (void *)0x703000;
+#ifndef ROMFS_DEFAULT_ADDR
+#ifdef ROMFS_HOST
+#define ROMFS_DEFAULT_ADDR  0
+#else
+#define ROMFS_DEFAULT_ADDR  0x703000
+#endif
+#endif
 
-void romfs_mount(void *addr)
+static void *romfs_addr = (void *)ROMFS_DEFAULT_ADDR;
+static uint32_t romfs_link_base = ROMFS_DEFAULT_ADDR;
+
+/* Resolve an address stored in the image */
+#define ROMFS_PTR(type, v)  ((type)((uint8_t *)romfs_addr + ((uint32_t)(v) - romfs_link_base)))
+
+/* Resolved paths, so opening the same asset again skips the directory walk */
+struct romfs_lookup_entry
 {
+    uint32_t hash;
+    struct romfs_dirent *dirent;
+    char path[ROMFS_LOOKUP_CACHE_PATH_LEN];
+};
+
+static struct romfs_lookup_entry romfs_lookup_cache[ROMFS_LOOKUP_CACHE_SIZE];
+static struct romfs_fd romfs_fd_pool[ROMFS_FD_MAX];
+
+#ifdef ROMFS_HOST
+/* Host tools are single threaded */
+#define ROMFS_LOCK()
+#define ROMFS_UNLOCK()
+#define RTK_LOGS(tag, level, ...)   printf(__VA_ARGS__)
+#else
+static rtos_mutex_t romfs_lock;
+
+/* The lock is created by romfs_mount, the default image may be used without it */
+#define ROMFS_LOCK()    do { if (romfs_lock) rtos_mutex_take(romfs_lock, MUTEX_WAIT_TIMEOUT); } while (0)
+#define ROMFS_UNLOCK()  do { if (romfs_lock) rtos_mutex_give(romfs_lock); } while (0)
+#endif
+
+void romfs_mount_image(void *addr, uint32_t link_base)
+{
+#ifndef ROMFS_HOST
+    if (romfs_lock == NULL)
+    {
+        rtos_mutex_create(&romfs_lock);
+    }
+#endif
+
+    ROMFS_LOCK();
     romfs_addr = addr;
+    romfs_link_base = link_base;
+    memset(romfs_lookup_cache, 0, sizeof(romfs_lookup_cache));
+    ROMFS_UNLOCK();
 }
 
+void romfs_mount(void *addr)
+{
+    romfs_mount_image(addr, (uint32_t)(uintptr_t)addr);
+}
+
+
+/**
+ * @ingroup Fd
+ *
+ * This function will return a file descriptor structure according to file
+ * descriptor.
+ *
+ * @return NULL on on this file descriptor or the file descriptor structure
+ * pointer.
+ */
+static struct romfs_fd *fd_get(int fd)
+{
+    if (fd < 0 || fd >= ROMFS_FD_MAX || romfs_fd_pool[fd].ref_count == 0)
+    {
+        return NULL;
+    }
+    return &romfs_fd_pool[fd];
+}
 
 int check_dirent(struct romfs_dirent *dirent)
 {
-    if ((dirent->type != ROMFS_DIRENT_FILE && dirent->type != ROMFS_DIRENT_DIR)
+    uint32_t type = dirent->type & ROMFS_DIRENT_TYPE_MASK;
+
+    if ((type != ROMFS_DIRENT_FILE && type != ROMFS_DIRENT_DIR)
         || dirent->size == ~0)
     {
         return -1;
@@ -150,18 +224,87 @@ int check_dirent(struct romfs_dirent *dirent)
     return 0;
 }
 
+static uint32_t romfs_path_hash(const char *path)
+{
+    uint32_t hash = 2166136261u;
+
+    while (*path)
+    {
+        hash = (hash ^ (uint8_t)*path++) * 16777619u;
+    }
+
+    return hash;
+}
+
+/* Compare a dirent name with a path component that isn't null terminated */
+static int romfs_name_cmp(const char *name, const char *comp, size_t len)
+{
+    int ret = strncmp(name, comp, len);
+
+    if (ret == 0 && name[len] != '\0')
+    {
+        return 1;
+    }
+    return ret;
+}
+
+static struct romfs_dirent *romfs_dir_find(struct romfs_dirent *dir, const char *comp, size_t len)
+{
+    struct romfs_dirent *entries = ROMFS_PTR(struct romfs_dirent *, dir->data);
+    size_t index;
+
+    if (dir->type & ROMFS_DIRENT_SORTED)
+    {
+        size_t lo = 0, hi = dir->size;
+
+        while (lo < hi)
+        {
+            size_t mid = lo + (hi - lo) / 2;
+            int ret = romfs_name_cmp(ROMFS_PTR(const char *, entries[mid].name), comp, len);
+
+            if (ret == 0)
+            {
+                return check_dirent(&entries[mid]) == 0 ? &entries[mid] : NULL;
+            }
+            if (ret < 0)
+            {
+                lo = mid + 1;
+            }
+            else
+            {
+                hi = mid;
+            }
+        }
+        return NULL;
+    }
+
+    for (index = 0; index < dir->size; index ++)
+    {
+        if (check_dirent(&entries[index]) != 0)
+        {
+            printf("romfs_lookup check folder dirent is null\n");
+            return NULL;
+        }
+        if (romfs_name_cmp(ROMFS_PTR(const char *, entries[index].name), comp, len) == 0)
+        {
+            return &entries[index];
+        }
+    }
+
+    return NULL;
+}
+
 struct romfs_dirent *romfs_lookup(struct romfs_dirent *root_dirent, const char *path, size_t *size)
 {
 #ifdef DEBUG
     printf("romfs_lookup start %s\n", path);
 #endif
-    size_t index, found;
-    const char *subpath, *subpath_end;
     struct romfs_dirent *dirent;
-    size_t dirent_size;
-#ifdef DEBUG
-    printf("romfs_lookup check root dirent type %ld size %d\n", root_dirent->type, root_dirent->size);
-#endif
+    struct romfs_lookup_entry *cached;
+    const char *subpath;
+    size_t len;
+    uint32_t hash;
+
     /* Check the root_dirent. */
     if (check_dirent(root_dirent) != 0)
     {
@@ -169,116 +312,217 @@ struct romfs_dirent *romfs_lookup(struct romfs_dirent *root_dirent, const char *
         return NULL;
     }
 
-    if (path)
+    if (path == NULL)
+    {
+        return NULL;
+    }
+
+    hash = romfs_path_hash(path);
+    cached = &romfs_lookup_cache[hash % ROMFS_LOOKUP_CACHE_SIZE];
+
+    ROMFS_LOCK();
+    if (cached->dirent && cached->hash == hash && strcmp(cached->path, path) == 0)
+    {
+        dirent = cached->dirent;
+        ROMFS_UNLOCK();
+        *size = dirent->size;
+        return dirent;
+    }
+    ROMFS_UNLOCK();
+
+    /* walk the path a component at a time, skipping /// */
+    dirent = root_dirent;
+    subpath = path;
+    for (;;)
     {
-        if (path[0] == '/' && path[1] == '\0')
+        while (*subpath == '/')
         {
-            *size = root_dirent->size;
-            return root_dirent;
+            subpath ++;
         }
+        if (*subpath == '\0')
+        {
+            break;
+        }
+
+        if (!ROMFS_DIRENT_IS_DIR(dirent))
+        {
+            dirent = NULL;    /* a file in the middle of the path */
+            break;
+        }
+
+        len = 0;
+        while (subpath[len] != '/' && subpath[len] != '\0')
+        {
+            len ++;
+        }
+
+#ifdef DEBUG
+        printf("romfs_lookup subpath %.*s\n", (int)len, subpath);
+#endif
+        dirent = romfs_dir_find(dirent, subpath, len);
+        if (dirent == NULL)
+        {
+            break;
+        }
+        subpath += len;
+    }
+
+    if (dirent == NULL)
+    {
+        /* not found */
+        printf("romfs_lookup not found\n");
+        return NULL;
+    }
+
+    if (strlen(path) < ROMFS_LOOKUP_CACHE_PATH_LEN)
+    {
+        ROMFS_LOCK();
+        cached->hash = hash;
+        cached->dirent = dirent;
+        strcpy(cached->path, path);
+        ROMFS_UNLOCK();
+    }
+
+    *size = dirent->size;
+    return dirent;
+}
+
+#ifdef CONFIG_ZLIB_ENABLE
+struct romfs_zblock
+{
+    const struct romfs_zhdr *hdr;
+    uint32_t index;
+    uint32_t stamp;
+    uint8_t *buf;
+};
+
+static struct romfs_zblock romfs_zblock_cache[ROMFS_ZBLOCK_CACHE_CNT];
+static uint32_t romfs_zblock_stamp;
+static z_stream romfs_zstream;
+static int romfs_zstream_ready;
+
+static int romfs_zhdr_check(const struct romfs_dirent *dirent)
+{
+    const struct romfs_zhdr *hdr = ROMFS_PTR(const struct romfs_zhdr *, dirent->data);
+
+    if (hdr->magic != ROMFS_ZHDR_MAGIC || hdr->block_size == 0 || hdr->block_size > ROMFS_ZBLOCK_SIZE_MAX
+        || hdr->block_cnt != (dirent->size + hdr->block_size - 1) / hdr->block_size)
+    {
+        return -1;
     }
+    return 0;
+}
 
-    /* goto root directory entries */
-    dirent = (struct romfs_dirent *)root_dirent->data;
-    dirent_size = root_dirent->size;
+/* Plain bytes of one block, from flash when stored or from the cache. Called with the lock held. */
+static const uint8_t *romfs_zblock_get(const struct romfs_zhdr *hdr, uint32_t index, uint32_t plain_len)
+{
+    const uint8_t *src = (const uint8_t *)hdr + hdr->offset[index];
+    uint32_t src_len = hdr->offset[index + 1] - hdr->offset[index];
+    struct romfs_zblock *slot = &romfs_zblock_cache[0];
+    uLongf out_len = plain_len;
+    int i;
 
-    /* get the end position of this subpath */
-    subpath_end = path;
-    /* skip /// */
-    if (subpath_end)
+    if (src_len == plain_len)
     {
-        while (*subpath_end == '/')
+        return src;
+    }
+
+    for (i = 0; i < ROMFS_ZBLOCK_CACHE_CNT; i++)
+    {
+        struct romfs_zblock *b = &romfs_zblock_cache[i];
+
+        if (b->hdr == hdr && b->index == index)
         {
-            subpath_end ++;
+            b->stamp = ++romfs_zblock_stamp;
+            return b->buf;
         }
-        subpath = subpath_end;
-        while ((*subpath_end != '/') && *subpath_end)
+        if (b->stamp < slot->stamp)
         {
-            subpath_end ++;
+            slot = b;
         }
     }
 
-    while (dirent != NULL)
+    if (slot->buf == NULL)
     {
-        found = 0;
+        slot->buf = malloc(ROMFS_ZBLOCK_SIZE_MAX);
+        if (slot->buf == NULL)
+        {
+            return NULL;
+        }
+    }
 
-        /* search in folder */
-        for (index = 0; index < dirent_size; index ++)
+    /* One inflate state for all blocks, it is only reset in between */
+    if (!romfs_zstream_ready)
+    {
+        memset(&romfs_zstream, 0, sizeof(romfs_zstream));
+        if (inflateInit(&romfs_zstream) != Z_OK)
         {
-#ifdef DEBUG
-            printf("dirent[index].name %s , subpath %s\n", dirent[index].name, subpath);
-#endif
-            if (check_dirent(&dirent[index]) != 0)
-            {
-                printf("romfs_lookup check folder dirent is null\n");
-                return NULL;
-            }
-            if (subpath_end && subpath && (subpath_end - subpath) >= 0)
-            {
-                if (strlen(dirent[index].name) == (subpath_end - subpath) &&
-                    strncmp(dirent[index].name, subpath, (subpath_end - subpath)) == 0)
-                {
-                    dirent_size = dirent[index].size;
-
-                    /* skip /// */
-                    if (subpath_end)
-                    {
-                        while (*subpath_end == '/')
-                        {
-                            subpath_end ++;
-                            if (!subpath_end)
-                            {
-                                break;
-                            }
-                        }
-                        subpath = subpath_end;
-                        while ((*subpath_end != '/') && *subpath_end)
-                        {
-                            subpath_end ++;
-                        }
-                    }
-                    char sp = 0;
-                    if (subpath != NULL)
-                    {
-                        sp = *subpath;
-                    }
-                    if (!(sp))
-                    {
-                        *size = dirent_size;
-                        return &dirent[index];
-                    }
-
-                    if (dirent[index].type == ROMFS_DIRENT_DIR)
-                    {
-                        /* enter directory */
-                        dirent = (struct romfs_dirent *)dirent[index].data;
-                        found = 1;
-                        break;
-                    }
-                    else
-                    {
-                        /* return file dirent */
-                        //if (subpath != NULL)
-                        {
-                            break;    /* not the end of path */
-                        }
-
-                        //return &dirent[index];
-                    }
-                }
-            }
+            return NULL;
+        }
+        romfs_zstream_ready = 1;
+    }
+    else if (inflateReset(&romfs_zstream) != Z_OK)
+    {
+        return NULL;
+    }
+
+    romfs_zstream.next_in = (Bytef *)src;
+    romfs_zstream.avail_in = src_len;
+    romfs_zstream.next_out = slot->buf;
+    romfs_zstream.avail_out = out_len;
+    if (inflate(&romfs_zstream, Z_FINISH) != Z_STREAM_END || romfs_zstream.total_out != out_len)
+    {
+        printf("romfs zlib block %lu inflate fail\n", (unsigned long)index);
+        slot->hdr = NULL;
+        return NULL;
+    }
+
+    slot->hdr = hdr;
+    slot->index = index;
+    slot->stamp = ++romfs_zblock_stamp;
+
+    return slot->buf;
+}
+
+static int romfs_read_zlib(struct romfs_fd *file, struct romfs_dirent *dirent, uint8_t *buf, size_t length)
+{
+    const struct romfs_zhdr *hdr = ROMFS_PTR(const struct romfs_zhdr *, dirent->data);
+    size_t done = 0;
+
+    ROMFS_LOCK();
+    while (done < length)
+    {
+        uint32_t pos = file->pos + done;
+        uint32_t index = pos / hdr->block_size;
+        uint32_t offset = pos % hdr->block_size;
+        uint32_t plain_len = hdr->block_size;
+        size_t n;
+
+        if (index == hdr->block_cnt - 1)
+        {
+            plain_len = dirent->size - index * hdr->block_size;
         }
 
-        if (!found)
+        const uint8_t *plain = romfs_zblock_get(hdr, index, plain_len);
+        if (plain == NULL)
         {
-            break;    /* not found */
+            ROMFS_UNLOCK();
+            return -EIO;
+        }
+
+        n = plain_len - offset;
+        if (n > length - done)
+        {
+            n = length - done;
         }
+        memcpy(buf + done, plain + offset, n);
+        done += n;
     }
+    ROMFS_UNLOCK();
 
-    /* not found */
-    printf("romfs_lookup not found\n");
-    return NULL;
+    return 0;
 }
+#endif
 
 int romfs_read(struct romfs_fd *file, void *buf, size_t count)
 {
@@ -303,7 +547,21 @@ int romfs_read(struct romfs_fd *file, void *buf, size_t count)
 
     if (length > 0)
     {
-        memcpy(buf, &(dirent->data[file->pos]), length);
+        if (dirent->type & ROMFS_DIRENT_ZLIB)
+        {
+#ifdef CONFIG_ZLIB_ENABLE
+            if (romfs_read_zlib(file, dirent, buf, length) < 0)
+            {
+                return -EIO;
+            }
+#else
+            return -ENOTSUPP;
+#endif
+        }
+        else
+        {
+            memcpy(buf, ROMFS_PTR(const uint8_t *, dirent->data) + file->pos, length);
+        }
     }
 
     /* update file current position */
@@ -362,7 +620,7 @@ int romfs_open(struct romfs_fd *file)
         }
 
         /* entry is a directory file type */
-        if (dirent->type == ROMFS_DIRENT_DIR)
+        if (ROMFS_DIRENT_IS_DIR(dirent))
         {
             if (!(file->flags & O_DIRECTORY))
             {
@@ -378,6 +636,20 @@ int romfs_open(struct romfs_fd *file)
                 printf("romfs_open ENOENT fail 3\n");
                 return -ENOENT;
             }
+
+            if (dirent->type & ROMFS_DIRENT_ZLIB)
+            {
+#ifdef CONFIG_ZLIB_ENABLE
+                if (romfs_zhdr_check(dirent) != 0)
+                {
+                    printf("romfs_open zlib header fail\n");
+                    return -EIO;
+                }
+#else
+                printf("romfs_open zlib not enabled\n");
+                return -ENOTSUPP;
+#endif
+            }
         }
 
         file->data = dirent;
@@ -394,35 +666,53 @@ int r_open(const char *file, int flags, ...)
     printf("romfs r_open %s flags %d\n", file, flags);
 #endif
     int result;
-    struct romfs_fd *fd;
+    int f;
+    struct romfs_fd *fd = NULL;
 
-    /* allocate a fd */
-    fd = malloc(sizeof(struct romfs_fd));
-    if (fd)
+    if (romfs_addr == NULL)
     {
-        fd->flags = flags;
-        fd->size  = 0;
-        fd->pos   = 0;
-        fd->data  = (void *)romfs_addr;
-        fd->path = (char *)file;
+        return -1;
+    }
+
+    /* allocate a fd from the pool */
+    ROMFS_LOCK();
+    for (f = 0; f < ROMFS_FD_MAX; f++)
+    {
+        if (romfs_fd_pool[f].ref_count == 0)
+        {
+            fd = &romfs_fd_pool[f];
+            fd->ref_count = 1;
+            break;
+        }
     }
+    ROMFS_UNLOCK();
+
+    if (fd == NULL)
+    {
+        printf("romfs_open EMFILE fail\n");
+        return -1;
+    }
+
+    fd->flags = flags;
+    fd->size  = 0;
+    fd->pos   = 0;
+    fd->data  = (void *)romfs_addr;
+    fd->path = (char *)file;
 
     result = romfs_open(fd);
     if (result < 0)
     {
-        free(fd);
+        fd->ref_count = 0;
         return -1;
     }
 
-    int f = (int)fd;
-
     return f;
 }
 
 int r_close(int fd)
 {
     int result;
-    struct romfs_fd *d = (struct romfs_fd *)fd;
+    struct romfs_fd *d = fd_get(fd);
 
     if (d == NULL)
     {
@@ -436,8 +726,8 @@ int r_close(int fd)
         return -1;
     }
 
-    free(d);
-    d = NULL;
+    d->path = NULL;
+    d->ref_count = 0;
 
     return 0;
 }
@@ -445,7 +735,7 @@ int r_close(int fd)
 int r_read(int fd, void *buf, size_t len)
 {
     int result;
-    struct romfs_fd *d = (struct romfs_fd *)fd;
+    struct romfs_fd *d = fd_get(fd);
 
     /* get the fd */
     if (d == NULL)
@@ -467,7 +757,7 @@ int r_read(int fd, void *buf, size_t len)
 off_t r_lseek(int fd, off_t offset, int whence)
 {
     int result;
-    struct romfs_fd *d = (struct romfs_fd *)fd;
+    struct romfs_fd *d = fd_get(fd);
 
     if (d == NULL)
     {
@@ -515,7 +805,7 @@ off_t r_lseek(int fd, off_t offset, int whence)
  */
 int r_closedir(DIR *d)
 {
-    if (d->fd == 0)
+    if (d == NULL || fd_get(d->fd) == NULL)
     {
 
         return -1;
@@ -577,7 +867,7 @@ static int dfs_romfs_getdents(struct romfs_fd *file, struct dirent *dirp, uint32
 
 
     /* enter directory */
-    dirent = (struct romfs_dirent *)dirent->data;
+    dirent = ROMFS_PTR(struct romfs_dirent *, dirent->data);
 
     /* make integer count */
     count = (count / sizeof(struct dirent));
@@ -592,10 +882,10 @@ static int dfs_romfs_getdents(struct romfs_fd *file, struct dirent *dirp, uint32
         d = dirp + index;
 
         sub_dirent = &dirent[file->pos];
-        name = sub_dirent->name;
+        name = ROMFS_PTR(const char *, sub_dirent->name);
 
         /* fill dirent */
-        if (sub_dirent->type == ROMFS_DIRENT_DIR)
+        if (ROMFS_DIRENT_IS_DIR(sub_dirent))
         {
             d->d_type = DT_DIR;
         }
@@ -604,9 +894,10 @@ static int dfs_romfs_getdents(struct romfs_fd *file, struct dirent *dirp, uint32
             d->d_type = DT_REG;
         }
 
-        d->d_namlen = strlen(name);
+        d->d_namlen = strnlen(name, sizeof(d->d_name) - 1);
         d->d_reclen = (uint16_t)sizeof(struct dirent);
-        strncpy(d->d_name, name, strlen(name) + 1);
+        memcpy(d->d_name, name, d->d_namlen);
+        d->d_name[d->d_namlen] = '\0';
 
         /* move to next position */
         ++ file->pos;
@@ -614,19 +905,6 @@ static int dfs_romfs_getdents(struct romfs_fd *file, struct dirent *dirp, uint32
 
     return index * sizeof(struct dirent);
 }
-/**
- * @ingroup Fd
- *
- * This function will return a file descriptor structure according to file
- * descriptor.
- *
- * @return NULL on on this file descriptor or the file descriptor structure
- * pointer.
- */
-static struct romfs_fd *fd_get(int fd)
-{
-    return (void *)fd;
-}
 static int dfs_romfs_ioctl(struct romfs_fd *file, int cmd, void *args)
 {
     switch (cmd)
@@ -637,12 +915,14 @@ static int dfs_romfs_ioctl(struct romfs_fd *file, int cmd, void *args)
 
             dirent = (struct romfs_dirent *)file->data;
 
-            if (check_dirent(dirent) != 0)
+            if (check_dirent(dirent) != 0 || (dirent->type & ROMFS_DIRENT_ZLIB) || args == NULL)
             {
                 return -EIO;
             }
 
-            return (int) & (dirent->data[file->pos]);
+            /* the address at the current position, an int can't hold a pointer everywhere */
+            *(const void **)args = ROMFS_PTR(const uint8_t *, dirent->data) + file->pos;
+            return 0;
 
         }
     }
@@ -714,7 +994,7 @@ int r_write(int fd, const void *buf, size_t len)
     (void)len;
     return 0;
 }
-int fcntl(int fildes, int cmd, ...)
+static int romfs_fcntl(int fildes, int cmd, ...)
 {
     int ret = -1;
     struct romfs_fd *d;
@@ -763,10 +1043,45 @@ int r_ioctl(int fildes, int cmd, ...)
     va_end(ap);
 
     /* we use fcntl for this API. */
-    return fcntl(fildes, cmd, arg);
+    return romfs_fcntl(fildes, cmd, arg);
 }
 
 int r_getsize(int fd) {
     struct romfs_fd *r = fd_get(fd);
-    return r->size;
-}
\ No newline at end of file
+    return r ? (int)r->size : -1;
+}
+
+/**
+ * this function returns the file contents in place, romfs files are stored
+ * contiguously in the mapped image so no copy is needed.
+ *
+ * @param fd the file descriptor
+ * @param size the file size on return.
+ *
+ * @return the file data, valid as long as the romfs image stays mounted,
+ * NULL on failed or for directories.
+ */
+const void *r_mmap(int fd, size_t *size)
+{
+    struct romfs_fd *d = fd_get(fd);
+    struct romfs_dirent *dirent;
+
+    if (d == NULL)
+    {
+        return NULL;
+    }
+
+    /* compressed files have no plain copy to map */
+    dirent = (struct romfs_dirent *)d->data;
+    if (check_dirent(dirent) != 0 || dirent->type != ROMFS_DIRENT_FILE)
+    {
+        return NULL;
+    }
+
+    if (size)
+    {
+        *size = d->size;
+    }
+
+    return ROMFS_PTR(const void *, dirent->data);
+}
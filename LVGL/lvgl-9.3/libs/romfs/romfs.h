@@ -14,9 +14,32 @@
 
 #include "stdint.h"
 #include "string.h"
+#include "romfs_format.h"
 
+#ifdef ROMFS_HOST
+#include <sys/types.h>
+#else
 typedef signed long off_t;
+#endif
+
+/* Files open at the same time, descriptors come from a static pool */
+#ifndef ROMFS_FD_MAX
+#define ROMFS_FD_MAX                    16
+#endif
 
+/* Resolved paths remembered by romfs_lookup, longer paths are always walked */
+#ifndef ROMFS_LOOKUP_CACHE_SIZE
+#define ROMFS_LOOKUP_CACHE_SIZE         32
+#endif
+
+#ifndef ROMFS_LOOKUP_CACHE_PATH_LEN
+#define ROMFS_LOOKUP_CACHE_PATH_LEN     64
+#endif
+
+/* Decompressed blocks of zlib compressed files kept for the next reads */
+#ifndef ROMFS_ZBLOCK_CACHE_CNT
+#define ROMFS_ZBLOCK_CACHE_CNT          2
+#endif
 
 struct romfs_fd
 {
@@ -30,14 +53,10 @@ struct romfs_fd
     void *data;                  /* Specific file system data */
 };
 
-struct romfs_dirent
-{
-    uint32_t      type;  /* dirent type */
-
-    const char       *name; /* dirent name */
-    const uint8_t *data; /* file date ptr */
-    size_t        size;  /* file size */
-};
+/* romfs_readdir d_type */
+#define DT_UNKNOWN              0x00
+#define DT_REG                  0x01
+#define DT_DIR                  0x02
 
 typedef struct
 {
@@ -56,7 +75,7 @@ struct dirent
 };
 
 void romfs_mount(void *addr);
-extern const struct romfs_dirent romfs_root;
+void romfs_mount_image(void *addr, uint32_t link_base);
 int r_open(const char *file, int flags, ...);
 int r_close(int fd);
 off_t r_lseek(int fd, off_t offset, int whence);
@@ -67,4 +86,5 @@ struct dirent *r_readdir(DIR *d);
 DIR *r_opendir(const char *name);
 int r_closedir(DIR *d);
 int r_getsize(int fd);
+const void *r_mmap(int fd, size_t *size);
 #endif
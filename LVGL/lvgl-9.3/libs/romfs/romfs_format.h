@@ -0,0 +1,67 @@
+/*
+ * Copyright (c) 2026 Realtek Semiconductor Corp.
+ * All rights reserved.
+ *
+ * Licensed under the Realtek License, Version 1.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License from Realtek
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/* Layout of a romfs image, shared by romfs.c and the host tools */
+
+#ifndef AMEBA_UI_LVGL_LIBS_ROMFS_ROMFS_FORMAT_H
+#define AMEBA_UI_LVGL_LIBS_ROMFS_ROMFS_FORMAT_H
+
+#include <stdint.h>
+
+#define ROMFS_DIRENT_FILE       0x00
+#define ROMFS_DIRENT_DIR        0x01
+#define ROMFS_DIRENT_TYPE_MASK  0x0F
+/* Set on a directory whose entries are sorted by name (strcmp order) */
+#define ROMFS_DIRENT_SORTED     0x10
+/* Set on a file stored as zlib compressed blocks, see struct romfs_zhdr */
+#define ROMFS_DIRENT_ZLIB       0x20
+
+/*
+ * The image starts with the root dirent. Addresses are 32-bit and relative to
+ * the link base the image was built for, which is the mount address unless
+ * it is mounted with romfs_mount_image().
+ */
+struct romfs_dirent
+{
+    uint32_t      type;  /* dirent type */
+
+    uint32_t      name;  /* address of the dirent name */
+    uint32_t      data;  /* address of the file data, or of the entries of a directory */
+    uint32_t      size;  /* file size, or number of entries of a directory */
+};
+
+/* Largest block size of compressed files that can be opened */
+#ifndef ROMFS_ZBLOCK_SIZE_MAX
+#define ROMFS_ZBLOCK_SIZE_MAX           (8 * 1024)
+#endif
+
+#define ROMFS_ZHDR_MAGIC                0x315A5252  /* "RRZ1" */
+
+/*
+ * Data of a file flagged ROMFS_DIRENT_ZLIB: this header, then the blocks.
+ * Every block_size bytes of the file are compressed as a separate zlib
+ * stream so any offset can be read by inflating a single block. A block
+ * whose compressed size equals its plain size is stored uncompressed.
+ * The dirent size is the uncompressed file size.
+ */
+struct romfs_zhdr
+{
+    uint32_t magic;
+    uint32_t block_size;
+    uint32_t block_cnt;
+    uint32_t offset[];      /* block_cnt + 1 offsets from the header start */
+};
+
+#endif /* AMEBA_UI_LVGL_LIBS_ROMFS_ROMFS_FORMAT_H */
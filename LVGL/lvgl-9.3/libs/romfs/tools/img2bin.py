@@ -0,0 +1,371 @@
+#!/usr/bin/env python3
+#
+# Copyright (c) 2026 Realtek Semiconductor Corp.
+# All rights reserved.
+#
+# Licensed under the Realtek License, Version 1.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License from Realtek
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+
+"""
+Convert PNG/JPEG/QOI assets into LVGL binary images (.bin) in the color
+format the target draws natively, so they are shown straight from romfs
+without decoding (see lv_fs_romfs_load_image_dsc()).
+
+  img2bin.py --target amebagreen2 -o out.bin in.png
+  img2bin.py --target amebasmart --tree assets/ build/assets/
+  img2bin.py --target amebagreen2 --tree assets/ build/assets/ --image romfs.bin
+  img2bin.py --target amebagreen2 --config build/.config -o out.bin in.png
+
+With --tree, images in the source tree are converted and every other file is
+copied as is; --image then runs mkromfs on the result. The color format
+follows LV_COLOR_DEPTH of config/<target>/lv_conf.h: RGB565 / RGB565A8 for
+16-bit targets, XRGB8888 / ARGB8888 for 32-bit ones, the alpha variant only
+for images that aren't fully opaque. Where lv_conf.h takes the depth from
+Kconfig (AmebaGreen2), --config reads it from the build's .config, without it
+the Kconfig default of 32 bits is used. --color-depth overrides both.
+
+PNG and QOI are read without extra packages, JPEG needs Pillow.
+"""
+
+import argparse
+import os
+import re
+import shutil
+import struct
+import subprocess
+import sys
+import zlib
+
+LV_IMAGE_HEADER_MAGIC = 0x19
+LV_IMAGE_FLAGS_COMPRESSED = 0x0008
+LV_IMAGE_COMPRESS_RLE = 1
+
+# lv_color_format_t values and bytes per pixel of the main plane
+COLOR_FORMATS = {
+    "RGB565": (0x12, 2),
+    "RGB565A8": (0x14, 2),
+    "RGB888": (0x0F, 3),
+    "ARGB8888": (0x10, 4),
+    "XRGB8888": (0x11, 4),
+}
+
+IMAGE_EXTS = (".png", ".jpg", ".jpeg", ".qoi")
+
+CONFIG_DIR = os.path.join(os.path.dirname(os.path.abspath(__file__)), "..", "..", "..", "config")
+
+
+def kconfig_enabled(config, name):
+    with open(config) as f:
+        return re.search(r"^%s=y\s*$" % name, f.read(), re.M) is not None
+
+
+def target_color_depth(target, lv_conf=None, config=None):
+    path = lv_conf or os.path.join(CONFIG_DIR, target, "lv_conf.h")
+    with open(path) as f:
+        text = f.read()
+    # Picked by the "LVGL Color Depth" Kconfig choice, 32 bits by default
+    if "CONFIG_LVGL_COLOR_DEPTH_16" in text:
+        return 16 if config and kconfig_enabled(config, "CONFIG_LVGL_COLOR_DEPTH_16") else 32
+    m = re.search(r"^\s*#define\s+LV_COLOR_DEPTH\s+(\d+)", text, re.M)
+    if not m:
+        sys.exit("LV_COLOR_DEPTH not found in " + path)
+    return int(m.group(1))
+
+
+# ---------------------------------------------------------------------------
+# Decoders, each returns (width, height, rows of RGBA bytes)
+
+def _png_unfilter(raw, w, h, bpp):
+    stride = w * bpp
+    rows = []
+    prev = bytearray(stride)
+    pos = 0
+    for _ in range(h):
+        ftype = raw[pos]
+        cur = bytearray(raw[pos + 1:pos + 1 + stride])
+        pos += 1 + stride
+        for i in range(stride):
+            a = cur[i - bpp] if i >= bpp else 0
+            b = prev[i]
+            c = prev[i - bpp] if i >= bpp else 0
+            if ftype == 1:
+                cur[i] = (cur[i] + a) & 0xFF
+            elif ftype == 2:
+                cur[i] = (cur[i] + b) & 0xFF
+            elif ftype == 3:
+                cur[i] = (cur[i] + ((a + b) >> 1)) & 0xFF
+            elif ftype == 4:
+                p = a + b - c
+                pa, pb, pc = abs(p - a), abs(p - b), abs(p - c)
+                pred = a if pa <= pb and pa <= pc else (b if pb <= pc else c)
+                cur[i] = (cur[i] + pred) & 0xFF
+        rows.append(cur)
+        prev = cur
+    return rows
+
+
+def decode_png(data):
+    if data[:8] != b"\x89PNG\r\n\x1a\n":
+        raise ValueError("not a PNG")
+    pos = 8
+    idat = b""
+    palette = None
+    trns = None
+    while pos < len(data):
+        length, ctype = struct.unpack(">I4s", data[pos:pos + 8])
+        chunk = data[pos + 8:pos + 8 + length]
+        pos += 12 + length
+        if ctype == b"IHDR":
+            w, h, depth, color, _, _, interlace = struct.unpack(">IIBBBBB", chunk)
+        elif ctype == b"PLTE":
+            palette = chunk
+        elif ctype == b"tRNS":
+            trns = chunk
+        elif ctype == b"IDAT":
+            idat += chunk
+        elif ctype == b"IEND":
+            break
+
+    if depth != 8 or interlace:
+        raise ValueError("only 8-bit non-interlaced PNGs are supported without Pillow")
+    channels = {0: 1, 2: 3, 3: 1, 4: 2, 6: 4}[color]
+    rows = _png_unfilter(zlib.decompress(idat), w, h, channels)
+
+    out = []
+    for row in rows:
+        rgba = bytearray(w * 4)
+        for x in range(w):
+            if color == 0:
+                g = row[x]
+                px = (g, g, g, 0 if trns and g == trns[1] else 255)
+            elif color == 2:
+                r, g, b = row[x * 3:x * 3 + 3]
+                opaque = not trns or (r, g, b) != (trns[1], trns[3], trns[5])
+                px = (r, g, b, 255 if opaque else 0)
+            elif color == 3:
+                i = row[x]
+                a = trns[i] if trns and i < len(trns) else 255
+                px = (palette[i * 3], palette[i * 3 + 1], palette[i * 3 + 2], a)
+            elif color == 4:
+                g, a = row[x * 2:x * 2 + 2]
+                px = (g, g, g, a)
+            else:
+                px = tuple(row[x * 4:x * 4 + 4])
+            rgba[x * 4:x * 4 + 4] = bytes(px)
+        out.append(rgba)
+    return w, h, out
+
+
+def decode_qoi(data):
+    magic, w, h, _, _ = struct.unpack(">4sIIBB", data[:14])
+    if magic != b"qoif":
+        raise ValueError("not a QOI image")
+    index = [(0, 0, 0, 0)] * 64
+    r, g, b, a = 0, 0, 0, 255
+    pixels = bytearray()
+    pos = 14
+    run = 0
+    for _ in range(w * h):
+        if run:
+            run -= 1
+        else:
+            op = data[pos]
+            pos += 1
+            if op == 0xFE:
+                r, g, b = data[pos:pos + 3]
+                pos += 3
+            elif op == 0xFF:
+                r, g, b, a = data[pos:pos + 4]
+                pos += 4
+            elif op >> 6 == 0:
+                r, g, b, a = index[op]
+            elif op >> 6 == 1:
+                r = (r + ((op >> 4) & 3) - 2) & 0xFF
+                g = (g + ((op >> 2) & 3) - 2) & 0xFF
+                b = (b + (op & 3) - 2) & 0xFF
+            elif op >> 6 == 2:
+                dg = (op & 0x3F) - 32
+                op2 = data[pos]
+                pos += 1
+                r = (r + dg - 8 + (op2 >> 4)) & 0xFF
+                g = (g + dg) & 0xFF
+                b = (b + dg - 8 + (op2 & 0x0F)) & 0xFF
+            else:
+                run = op & 0x3F
+            index[(r * 3 + g * 5 + b * 7 + a * 11) % 64] = (r, g, b, a)
+        pixels += bytes((r, g, b, a))
+    return w, h, [pixels[y * w * 4:(y + 1) * w * 4] for y in range(h)]
+
+
+def decode_pillow(path):
+    try:
+        from PIL import Image
+    except ImportError:
+        raise ValueError("Pillow is needed for " + path)
+    img = Image.open(path).convert("RGBA")
+    w, h = img.size
+    raw = img.tobytes()
+    return w, h, [bytearray(raw[y * w * 4:(y + 1) * w * 4]) for y in range(h)]
+
+
+def load_image(path):
+    with open(path, "rb") as f:
+        data = f.read()
+    try:
+        if data[:8] == b"\x89PNG\r\n\x1a\n":
+            return decode_png(data)
+        if data[:4] == b"qoif":
+            return decode_qoi(data)
+    except ValueError:
+        pass
+    return decode_pillow(path)
+
+
+# ---------------------------------------------------------------------------
+# Encoder
+
+def convert_pixels(w, h, rows, cf, stride_align):
+    bpp = COLOR_FORMATS[cf][1]
+    stride = (w * bpp + stride_align - 1) // stride_align * stride_align
+    pad = bytes(stride - w * bpp)
+    planes = bytearray()
+    alpha = bytearray()
+
+    for row in rows:
+        line = bytearray()
+        for x in range(w):
+            r, g, b, a = row[x * 4:x * 4 + 4]
+            if cf in ("RGB565", "RGB565A8"):
+                line += struct.pack("<H", ((r >> 3) << 11) | ((g >> 2) << 5) | (b >> 3))
+            elif cf == "RGB888":
+                line += bytes((b, g, r))
+            elif cf == "XRGB8888":
+                line += bytes((b, g, r, 0xFF))
+            else:
+                line += bytes((b, g, r, a))
+        planes += line + pad
+        if cf == "RGB565A8":
+            # The alpha plane follows with half the stride
+            alpha += bytes(row[3::4]) + bytes(stride // 2 - w)
+
+    return stride, bytes(planes + alpha)
+
+
+def rle_compress(data, blk):
+    """LVGL RLE (lv_rle.c): ctrl < 0x80 repeats the next block, ctrl | 0x80 copies ctrl & 0x7F blocks"""
+    out = bytearray()
+    blocks = [data[i:i + blk] for i in range(0, len(data), blk)]
+    i = 0
+    n = len(blocks)
+    while i < n:
+        run = 1
+        while i + run < n and run < 127 and blocks[i + run] == blocks[i]:
+            run += 1
+        if run > 1:
+            out.append(run)
+            out += blocks[i]
+            i += run
+            continue
+        start = i
+        while i < n and i - start < 127 and (i + 1 >= n or blocks[i + 1] != blocks[i]):
+            i += 1
+        if i == start:
+            i += 1
+        out.append(0x80 | (i - start))
+        out += b"".join(blocks[start:i])
+    return bytes(out)
+
+
+def encode_bin(w, h, rows, cf, stride_align=1, rle=False):
+    cf_id, bpp = COLOR_FORMATS[cf]
+    stride, data = convert_pixels(w, h, rows, cf, stride_align)
+    flags = 0
+
+    if rle:
+        if cf == "RGB565A8":
+            print("RLE is not used for RGB565A8, its planes have different block sizes", file=sys.stderr)
+        else:
+            packed = rle_compress(data, bpp)
+            if len(packed) < len(data):
+                flags |= LV_IMAGE_FLAGS_COMPRESSED
+                data = struct.pack("<III", LV_IMAGE_COMPRESS_RLE, len(packed), len(data)) + packed
+
+    header = struct.pack("<BBHHHHH", LV_IMAGE_HEADER_MAGIC, cf_id, flags, w, h, stride, 0)
+    return header + data
+
+
+def pick_cf(depth, rows):
+    opaque = all(a == 255 for row in rows for a in row[3::4])
+    if depth == 16:
+        return "RGB565" if opaque else "RGB565A8"
+    if depth == 24:
+        return "RGB888" if opaque else "ARGB8888"
+    return "XRGB8888" if opaque else "ARGB8888"
+
+
+def convert_file(src, dst, args, depth):
+    w, h, rows = load_image(src)
+    cf = args.cf or pick_cf(depth, rows)
+    data = encode_bin(w, h, rows, cf, args.stride_align, args.rle)
+    with open(dst, "wb") as f:
+        f.write(data)
+    return cf, len(data)
+
+
+def convert_tree(src_dir, dst_dir, args, depth):
+    for root, _, files in os.walk(src_dir):
+        rel = os.path.relpath(root, src_dir)
+        out_dir = os.path.normpath(os.path.join(dst_dir, rel))
+        os.makedirs(out_dir, exist_ok=True)
+        for name in sorted(files):
+            src = os.path.join(root, name)
+            base, ext = os.path.splitext(name)
+            if ext.lower() in IMAGE_EXTS:
+                dst = os.path.join(out_dir, base + ".bin")
+                cf, size = convert_file(src, dst, args, depth)
+                print("%s -> %s (%s, %d bytes)" % (src, dst, cf, size))
+            else:
+                shutil.copyfile(src, os.path.join(out_dir, name))
+
+
+def main():
+    parser = argparse.ArgumentParser(description="Convert images to LVGL .bin for the target color format")
+    parser.add_argument("--target", default="amebagreen2", help="SoC whose lv_conf.h gives LV_COLOR_DEPTH")
+    parser.add_argument("--lv-conf", help="lv_conf.h to use instead of the target's")
+    parser.add_argument("--config", help="the build's .config, for a depth picked in Kconfig")
+    parser.add_argument("--color-depth", type=int, choices=(16, 32), help="override LV_COLOR_DEPTH")
+    parser.add_argument("--cf", choices=sorted(COLOR_FORMATS), help="force a color format")
+    parser.add_argument("--stride-align", type=int, default=1, help="bytes, as LV_DRAW_BUF_STRIDE_ALIGN")
+    parser.add_argument("--rle", action="store_true", help="RLE compress when smaller, needs LV_USE_RLE")
+    parser.add_argument("--tree", action="store_true", help="convert a directory tree")
+    parser.add_argument("--image", help="with --tree, build this romfs image from the output")
+    parser.add_argument("--mkromfs", default="mkromfs", help="mkromfs binary for --image")
+    parser.add_argument("--mkromfs-args", default="", help="extra mkromfs options, e.g. \"-a 32 -z\"")
+    parser.add_argument("-o", "--output", help="output file for a single image")
+    parser.add_argument("src")
+    parser.add_argument("dst", nargs="?")
+    args = parser.parse_args()
+
+    depth = args.color_depth or target_color_depth(args.target, args.lv_conf, args.config)
+
+    if args.tree:
+        if not args.dst:
+            parser.error("--tree needs a destination directory")
+        convert_tree(args.src, args.dst, args, depth)
+        if args.image:
+            subprocess.check_call([args.mkromfs] + args.mkromfs_args.split() + [args.dst, args.image])
+    else:
+        dst = args.output or args.dst or os.path.splitext(args.src)[0] + ".bin"
+        cf, size = convert_file(args.src, dst, args, depth)
+        print("%s -> %s (%s, %d bytes)" % (args.src, dst, cf, size))
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,343 @@
+/*
+ * Copyright (c) 2026 Realtek Semiconductor Corp.
+ * All rights reserved.
+ *
+ * Licensed under the Realtek License, Version 1.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License from Realtek
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/*
+ * Build a romfs image from a directory tree, to be flashed at the address
+ * lv_fs_romfs mounts (ROM_FS_ADDR).
+ *
+ *   gcc -O2 -DROMFS_HOST -I.. -o mkromfs mkromfs.c -lz
+ *   ./mkromfs [-b link_base] [-a align] [-z] [-c block_size] [-u] <dir> <image.bin>
+ *
+ * -b  address the image is mounted at, default 0x08400000
+ * -a  alignment of file data, e.g. 32 for cache line aligned DMA, default 4
+ * -z  store files as zlib compressed blocks when that saves space
+ * -c  compressed block size, default 4096
+ * -u  keep directories unsorted, only useful to compare lookup times
+ *
+ * The host zlib is enough, or compile the third_party/zlib sources along.
+ */
+
+#include <dirent.h>
+#include <errno.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+
+#include "zlib.h"
+#include "romfs_format.h"
+
+#define MKROMFS_DEFAULT_BASE    0x08400000u
+
+typedef struct {
+    uint8_t *data;
+    uint32_t size;
+    uint32_t cap;
+} image_t;
+
+typedef struct {
+    uint32_t link_base;
+    uint32_t align;
+    uint32_t block_size;
+    int compress;
+    int sorted;
+    uint32_t files;
+    uint32_t dirs;
+    uint64_t plain_bytes;
+    uint64_t stored_bytes;
+} opts_t;
+
+typedef struct {
+    char *name;
+    int is_dir;
+} entry_t;
+
+static void *xrealloc(void *p, size_t size)
+{
+    p = realloc(p, size);
+    if (p == NULL) {
+        fprintf(stderr, "out of memory\n");
+        exit(1);
+    }
+    return p;
+}
+
+/* Reserve len bytes at the end, aligned, and return their offset */
+static uint32_t image_alloc(image_t *img, uint32_t len, uint32_t align)
+{
+    uint32_t off = (img->size + align - 1) & ~(align - 1);
+
+    if (off + len > img->cap) {
+        uint32_t cap = img->cap ? img->cap : 64 * 1024;
+        while (off + len > cap) {
+            cap *= 2;
+        }
+        img->data = xrealloc(img->data, cap);
+        img->cap = cap;
+    }
+    memset(img->data + img->size, 0, off + len - img->size);
+    img->size = off + len;
+
+    return off;
+}
+
+static uint32_t image_put(image_t *img, const void *data, uint32_t len, uint32_t align)
+{
+    uint32_t off = image_alloc(img, len, align);
+    memcpy(img->data + off, data, len);
+    return off;
+}
+
+static void put_dirent(image_t *img, uint32_t off, uint32_t type, uint32_t name, uint32_t data, uint32_t size)
+{
+    struct romfs_dirent d;
+
+    /* The image is read in place by a little-endian target */
+    d.type = type;
+    d.name = name;
+    d.data = data;
+    d.size = size;
+    memcpy(img->data + off, &d, sizeof(d));
+}
+
+static uint8_t *read_whole(const char *path, uint32_t *size)
+{
+    FILE *f = fopen(path, "rb");
+    uint8_t *buf;
+    long len;
+
+    if (f == NULL) {
+        return NULL;
+    }
+    fseek(f, 0, SEEK_END);
+    len = ftell(f);
+    fseek(f, 0, SEEK_SET);
+
+    buf = xrealloc(NULL, len ? len : 1);
+    if (fread(buf, 1, len, f) != (size_t)len) {
+        free(buf);
+        buf = NULL;
+    }
+    fclose(f);
+    *size = (uint32_t)len;
+
+    return buf;
+}
+
+/* Compress in independent blocks, returns 0 if it doesn't save at least 1/8 */
+static int put_zlib_file(image_t *img, opts_t *o, const uint8_t *data, uint32_t size, uint32_t *off)
+{
+    uint32_t bs = o->block_size;
+    uint32_t cnt = (size + bs - 1) / bs;
+    uint32_t hdr_len = sizeof(struct romfs_zhdr) + (cnt + 1) * sizeof(uint32_t);
+    uLongf max = compressBound(bs);
+    uint8_t *tmp = xrealloc(NULL, hdr_len + cnt * max);
+    struct romfs_zhdr *hdr = (struct romfs_zhdr *)tmp;
+    uint32_t pos = hdr_len;
+    uint32_t i;
+
+    if (size == 0) {
+        free(tmp);
+        return 0;
+    }
+
+    hdr->magic = ROMFS_ZHDR_MAGIC;
+    hdr->block_size = bs;
+    hdr->block_cnt = cnt;
+    for (i = 0; i < cnt; i++) {
+        uint32_t plain = (i == cnt - 1) ? size - i * bs : bs;
+        uLongf len = max;
+
+        hdr->offset[i] = pos;
+        if (compress2(tmp + pos, &len, data + i * bs, plain, Z_BEST_COMPRESSION) != Z_OK || len >= plain) {
+            /* stored plain, romfs tells it by the equal size */
+            memcpy(tmp + pos, data + i * bs, plain);
+            len = plain;
+        }
+        pos += len;
+    }
+    hdr->offset[cnt] = pos;
+
+    if (pos > size - size / 8) {
+        free(tmp);
+        return 0;
+    }
+
+    *off = image_put(img, tmp, pos, o->align < 4 ? 4 : o->align);
+    o->stored_bytes += pos;
+    free(tmp);
+
+    return 1;
+}
+
+static int entry_cmp(const void *a, const void *b)
+{
+    return strcmp(((const entry_t *)a)->name, ((const entry_t *)b)->name);
+}
+
+static int list_dir(const char *path, entry_t **list, uint32_t *cnt)
+{
+    DIR *dir = opendir(path);
+    struct dirent *de;
+    char full[4096];
+    struct stat st;
+
+    *list = NULL;
+    *cnt = 0;
+    if (dir == NULL) {
+        fprintf(stderr, "can't open %s: %s\n", path, strerror(errno));
+        return -1;
+    }
+
+    while ((de = readdir(dir)) != NULL) {
+        if (strcmp(de->d_name, ".") == 0 || strcmp(de->d_name, "..") == 0) {
+            continue;
+        }
+        snprintf(full, sizeof(full), "%s/%s", path, de->d_name);
+        if (stat(full, &st) != 0 || !(S_ISDIR(st.st_mode) || S_ISREG(st.st_mode))) {
+            continue;
+        }
+        *list = xrealloc(*list, (*cnt + 1) * sizeof(entry_t));
+        (*list)[*cnt].name = strdup(de->d_name);
+        (*list)[*cnt].is_dir = S_ISDIR(st.st_mode);
+        (*cnt)++;
+    }
+    closedir(dir);
+
+    return 0;
+}
+
+/* Write the entries of a directory, their table offset and count go to table and cnt */
+static int put_dir(image_t *img, opts_t *o, const char *path, uint32_t *table, uint32_t *cnt)
+{
+    entry_t *list;
+    char full[4096];
+    uint32_t i;
+
+    if (list_dir(path, &list, cnt) != 0) {
+        return -1;
+    }
+    if (o->sorted) {
+        qsort(list, *cnt, sizeof(entry_t), entry_cmp);
+    }
+
+    *table = image_alloc(img, *cnt * sizeof(struct romfs_dirent), 4);
+    o->dirs++;
+
+    for (i = 0; i < *cnt; i++) {
+        uint32_t name = image_put(img, list[i].name, strlen(list[i].name) + 1, 1);
+        uint32_t ent = *table + i * sizeof(struct romfs_dirent);
+
+        snprintf(full, sizeof(full), "%s/%s", path, list[i].name);
+        if (list[i].is_dir) {
+            uint32_t sub, sub_cnt;
+            if (put_dir(img, o, full, &sub, &sub_cnt) != 0) {
+                return -1;
+            }
+            put_dirent(img, ent, ROMFS_DIRENT_DIR | (o->sorted ? ROMFS_DIRENT_SORTED : 0),
+                       o->link_base + name, o->link_base + sub, sub_cnt);
+        } else {
+            uint32_t size, off;
+            uint32_t type = ROMFS_DIRENT_FILE;
+            uint8_t *data = read_whole(full, &size);
+
+            if (data == NULL) {
+                fprintf(stderr, "can't read %s\n", full);
+                return -1;
+            }
+            if (o->compress && put_zlib_file(img, o, data, size, &off)) {
+                type |= ROMFS_DIRENT_ZLIB;
+            } else {
+                off = image_put(img, data, size, o->align);
+                o->stored_bytes += size;
+            }
+            o->plain_bytes += size;
+            o->files++;
+            free(data);
+
+            put_dirent(img, ent, type, o->link_base + name, o->link_base + off, size);
+        }
+        free(list[i].name);
+    }
+    free(list);
+
+    return 0;
+}
+
+static void usage(void)
+{
+    fprintf(stderr, "usage: mkromfs [-b link_base] [-a align] [-z] [-c block_size] [-u] <dir> <image.bin>\n");
+    exit(1);
+}
+
+int main(int argc, char **argv)
+{
+    opts_t o;
+    image_t img;
+    uint32_t table, cnt, name;
+    FILE *f;
+    int i;
+
+    memset(&o, 0, sizeof(o));
+    memset(&img, 0, sizeof(img));
+    o.link_base = MKROMFS_DEFAULT_BASE;
+    o.align = 4;
+    o.block_size = 4096;
+    o.sorted = 1;
+
+    for (i = 1; i < argc && argv[i][0] == '-'; i++) {
+        if (strcmp(argv[i], "-b") == 0 && i + 1 < argc) {
+            o.link_base = strtoul(argv[++i], NULL, 0);
+        } else if (strcmp(argv[i], "-a") == 0 && i + 1 < argc) {
+            o.align = strtoul(argv[++i], NULL, 0);
+        } else if (strcmp(argv[i], "-c") == 0 && i + 1 < argc) {
+            o.block_size = strtoul(argv[++i], NULL, 0);
+        } else if (strcmp(argv[i], "-z") == 0) {
+            o.compress = 1;
+        } else if (strcmp(argv[i], "-u") == 0) {
+            o.sorted = 0;
+        } else {
+            usage();
+        }
+    }
+    if (argc - i != 2 || o.align == 0 || (o.align & (o.align - 1)) ||
+        o.block_size == 0 || o.block_size > ROMFS_ZBLOCK_SIZE_MAX) {
+        usage();
+    }
+
+    /* The root dirent is at the mount address */
+    image_alloc(&img, sizeof(struct romfs_dirent), 4);
+    name = image_put(&img, "/", 2, 1);
+    if (put_dir(&img, &o, argv[i], &table, &cnt) != 0) {
+        return 1;
+    }
+    put_dirent(&img, 0, ROMFS_DIRENT_DIR | (o.sorted ? ROMFS_DIRENT_SORTED : 0),
+               o.link_base + name, o.link_base + table, cnt);
+
+    f = fopen(argv[i + 1], "wb");
+    if (f == NULL || fwrite(img.data, 1, img.size, f) != img.size) {
+        fprintf(stderr, "can't write %s\n", argv[i + 1]);
+        return 1;
+    }
+    fclose(f);
+
+    printf("%s: %u files in %u dirs, %llu -> %llu bytes of data, image %u bytes at 0x%08x\n",
+           argv[i + 1], o.files, o.dirs, (unsigned long long)o.plain_bytes,
+           (unsigned long long)o.stored_bytes, img.size, o.link_base);
+    free(img.data);
+
+    return 0;
+}
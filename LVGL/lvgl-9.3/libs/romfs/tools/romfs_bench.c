@@ -0,0 +1,217 @@
+/*
+ * Copyright (c) 2026 Realtek Semiconductor Corp.
+ * All rights reserved.
+ *
+ * Licensed under the Realtek License, Version 1.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License from Realtek
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/*
+ * Run romfs.c on the host against an image from mkromfs: check every file
+ * reads back like the source tree, then time lookups and reads.
+ *
+ *   gcc -O2 -DROMFS_HOST -DCONFIG_ZLIB_ENABLE -I.. -o romfs_bench romfs_bench.c ../romfs.c -lz
+ *   ./romfs_bench [-b link_base] [-n rounds] <image.bin> [source dir]
+ *
+ * -b must match the link base the image was built with.
+ */
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "romfs.h"
+
+#define BENCH_DEFAULT_BASE  0x08400000u
+#define BENCH_PATH_LEN      256
+#define BENCH_CHUNK         4096
+#define BENCH_RANDOM_READ   256
+
+typedef struct {
+    char (*paths)[BENCH_PATH_LEN];
+    uint32_t cnt;
+    uint32_t cap;
+} path_list_t;
+
+static uint64_t now_ns(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000u + ts.tv_nsec;
+}
+
+static void collect(path_list_t *list, const char *dir_path)
+{
+    DIR *dir = r_opendir(dir_path);
+    struct dirent *de;
+    char path[BENCH_PATH_LEN];
+
+    if (dir == NULL) {
+        return;
+    }
+
+    while ((de = r_readdir(dir)) != NULL) {
+        snprintf(path, sizeof(path), "%s/%s", strcmp(dir_path, "/") ? dir_path : "", de->d_name);
+        if (de->d_type == DT_DIR) {
+            collect(list, path);
+            continue;
+        }
+        if (list->cnt == list->cap) {
+            list->cap = list->cap ? list->cap * 2 : 256;
+            list->paths = realloc(list->paths, list->cap * BENCH_PATH_LEN);
+        }
+        memcpy(list->paths[list->cnt++], path, BENCH_PATH_LEN);
+    }
+    r_closedir(dir);
+}
+
+static int verify(const path_list_t *list, const char *src_dir)
+{
+    static uint8_t a[BENCH_CHUNK], b[BENCH_CHUNK];
+    char host_path[2 * BENCH_PATH_LEN];
+    int bad = 0;
+
+    for (uint32_t i = 0; i < list->cnt; i++) {
+        snprintf(host_path, sizeof(host_path), "%s%s", src_dir, list->paths[i]);
+        FILE *f = fopen(host_path, "rb");
+        int fd = r_open(list->paths[i], 0);
+        int n;
+
+        if (f == NULL || fd < 0) {
+            printf("verify: can't open %s\n", list->paths[i]);
+            bad++;
+        } else {
+            while ((n = r_read(fd, a, sizeof(a))) > 0) {
+                if (fread(b, 1, n, f) != (size_t)n || memcmp(a, b, n) != 0) {
+                    printf("verify: %s differs\n", list->paths[i]);
+                    bad++;
+                    break;
+                }
+            }
+        }
+        if (f) {
+            fclose(f);
+        }
+        if (fd >= 0) {
+            r_close(fd);
+        }
+    }
+
+    return bad;
+}
+
+int main(int argc, char **argv)
+{
+    uint32_t link_base = BENCH_DEFAULT_BASE;
+    uint32_t rounds = 20;
+    path_list_t list = {0};
+    static uint8_t buf[BENCH_CHUNK];
+    uint64_t t0, bytes = 0, reads = 0;
+    int i;
+
+    for (i = 1; i < argc && argv[i][0] == '-'; i++) {
+        if (strcmp(argv[i], "-b") == 0 && i + 1 < argc) {
+            link_base = strtoul(argv[++i], NULL, 0);
+        } else if (strcmp(argv[i], "-n") == 0 && i + 1 < argc) {
+            rounds = strtoul(argv[++i], NULL, 0);
+        }
+    }
+    if (i >= argc) {
+        fprintf(stderr, "usage: romfs_bench [-b link_base] [-n rounds] <image.bin> [source dir]\n");
+        return 1;
+    }
+
+    FILE *f = fopen(argv[i], "rb");
+    if (f == NULL) {
+        fprintf(stderr, "can't open %s\n", argv[i]);
+        return 1;
+    }
+    fseek(f, 0, SEEK_END);
+    long size = ftell(f);
+    fseek(f, 0, SEEK_SET);
+    uint8_t *image = malloc(size);
+    if (image == NULL || fread(image, 1, size, f) != (size_t)size) {
+        fprintf(stderr, "can't read %s\n", argv[i]);
+        return 1;
+    }
+    fclose(f);
+
+    romfs_mount_image(image, link_base);
+    collect(&list, "/");
+    printf("%u files in %ld bytes\n", list.cnt, size);
+    if (list.cnt == 0) {
+        return 1;
+    }
+
+    if (i + 1 < argc) {
+        int bad = verify(&list, argv[i + 1]);
+        printf("verify: %s\n", bad ? "FAILED" : "ok");
+        if (bad) {
+            return 1;
+        }
+    }
+
+    /* Cold: the lookup cache is cleared before every open */
+    t0 = now_ns();
+    for (uint32_t r = 0; r < rounds; r++) {
+        for (uint32_t k = 0; k < list.cnt; k++) {
+            romfs_mount_image(image, link_base);
+            r_close(r_open(list.paths[k], 0));
+        }
+    }
+    printf("open+close cold: %8.1f ns\n", (double)(now_ns() - t0) / ((uint64_t)rounds * list.cnt));
+
+    t0 = now_ns();
+    for (uint32_t r = 0; r < rounds; r++) {
+        for (uint32_t k = 0; k < list.cnt; k++) {
+            r_close(r_open(list.paths[k], 0));
+        }
+    }
+    printf("open+close warm: %8.1f ns\n", (double)(now_ns() - t0) / ((uint64_t)rounds * list.cnt));
+
+    t0 = now_ns();
+    for (uint32_t r = 0; r < rounds; r++) {
+        for (uint32_t k = 0; k < list.cnt; k++) {
+            int fd = r_open(list.paths[k], 0);
+            int n;
+            while ((n = r_read(fd, buf, sizeof(buf))) > 0) {
+                bytes += n;
+            }
+            r_close(fd);
+        }
+    }
+    double sec = (double)(now_ns() - t0) / 1e9;
+    printf("sequential read: %8.1f MB/s\n", bytes / sec / (1024 * 1024));
+
+    srand(1);
+    t0 = now_ns();
+    for (uint32_t r = 0; r < rounds; r++) {
+        for (uint32_t k = 0; k < list.cnt; k++) {
+            int fd = r_open(list.paths[k], 0);
+            int len = r_getsize(fd);
+            if (len > BENCH_RANDOM_READ) {
+                r_lseek(fd, rand() % (len - BENCH_RANDOM_READ), SEEK_SET);
+                r_read(fd, buf, BENCH_RANDOM_READ);
+                reads++;
+            }
+            r_close(fd);
+        }
+    }
+    if (reads) {
+        printf("random %d B read: %6.1f ns\n", BENCH_RANDOM_READ, (double)(now_ns() - t0) / reads);
+    }
+
+    free(list.paths);
+    free(image);
+
+    return 0;
+}
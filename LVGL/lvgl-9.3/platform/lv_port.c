@@ -29,6 +29,10 @@
 #include "lv_port_touch.h"
 #endif
 
+#ifdef RTK_ROMFS_ENABLE
+#include "lv_fs_romfs.h"
+#endif
+
 #define LOG_TAG "LV-Port"
 
 typedef struct {
@@ -44,6 +48,12 @@ typedef struct {
     uint16_t disp_height;
     uint8_t flip_index;
     bool is_running;
+    bool beam_racing;
+
+    /* Idle refresh rate */
+    uint32_t full_refresh_rate;
+    uint32_t last_flush_tick;
+    bool refresh_idle;
 
     /* Legacy path */
     lv_thread_sync_t    flip_sync;
@@ -66,8 +76,37 @@ static void display_vblank_handler(void) {
     }
 }
 
+static void splash_init(void) {
+#if defined(RTK_ROMFS_ENABLE) && defined(LV_PORT_SPLASH_PATH)
+    /* Runs before lv_init and fs_init, the romfs mount is all the lookup needs */
+    const void *frame;
+    uint32_t size;
+    uint32_t frame_size = display_mode_get_width() * display_mode_get_height() * (LV_COLOR_DEPTH / 8);
+
+    lv_fs_romfs_mount();
+    if (lv_fs_romfs_map(LV_PORT_SPLASH_PATH, &frame, &size) != LV_RESULT_OK) {
+        return;
+    }
+
+    /*
+     * The file is a headerless frame the LCDC scans out in place, its layout is
+     * the panel's. Not sniffed as an LVGL .bin, pixel data may start like one.
+     */
+    if (size != frame_size) {
+        RTK_LOGW(LOG_TAG, "%s is %u bytes, a raw %dx%d frame is %u, no splash\n", LV_PORT_SPLASH_PATH,
+                 size, display_mode_get_width(), display_mode_get_height(), frame_size);
+        return;
+    }
+
+    display_mode_set_splash(frame);
+#endif
+}
+
 static void display_init(void) {
-    display_mode_init(LV_COLOR_DEPTH);
+    /* Bring-up was started by lv_port_init, wait for the panel */
+    if (!display_mode_wait_ready()) {
+        RTK_LOGE(LOG_TAG, "display init failed\n");
+    }
 
     static display_mode_callback_t s_callback = {
         .vblank_handler = display_vblank_handler
@@ -150,8 +189,83 @@ static void screen_rotate(uint8_t *src, uint8_t *dst) {
     }
 }
 
+static void flush_area(lv_display_t *disp, const lv_area_t *area, uint8_t *px_map) {
+    /* The panel has its own frame memory, only the dirty area goes out */
+    if (!display_mode_flush_is_async()) {
+        /* DSI command mode writes from this task, done when it returns */
+        display_mode_flush_area(px_map, area->x1, area->y1, area->x2, area->y2);
+        lv_display_flush_ready(disp);
+        return;
+    }
+
+    s_ctx->flip_done = false;
+    if (display_mode_flush_area(px_map, area->x1, area->y1, area->x2, area->y2)) {
+        lv_thread_sync_wait(&s_ctx->flip_sync);
+    }
+    s_ctx->flip_done = true;
+
+    lv_display_flush_ready(disp);
+}
+
+static void refresh_activity(void) {
+#if LV_PORT_IDLE_REFRESH_MS
+    s_ctx->last_flush_tick = ameba_get_tick();
+    if (s_ctx->refresh_idle) {
+        /* Switches at the frame boundary this flush waits for */
+        display_mode_set_refresh_rate(s_ctx->full_refresh_rate);
+        s_ctx->refresh_idle = false;
+    }
+#endif
+}
+
+static void refresh_check_idle(void) {
+#if LV_PORT_IDLE_REFRESH_MS
+    if (s_ctx->refresh_idle || !s_ctx->full_refresh_rate ||
+        ameba_get_tick() - s_ctx->last_flush_tick < LV_PORT_IDLE_REFRESH_MS) {
+        return;
+    }
+
+    if (display_mode_set_refresh_rate(LV_PORT_IDLE_REFRESH_HZ)) {
+        s_ctx->refresh_idle = true;
+    } else {
+        /* Fixed rate panel, stop trying */
+        s_ctx->full_refresh_rate = 0;
+    }
+#endif
+}
+
+static void flush_band(lv_display_t *disp, const lv_area_t *area, uint8_t *px_map) {
+    /* buf1 is on screen, copy the band in once the scan line has just left it */
+    uint32_t bpp = s_ctx->color_depth / 8;
+    uint32_t stride = s_ctx->phys_width * bpp;
+    uint32_t line_len = lv_area_get_width(area) * bpp;
+    uint32_t next_line = (area->y2 + 1 < s_ctx->phys_height) ? area->y2 + 1 : 0;
+    uint8_t *dst = s_ctx->buf1 + area->y1 * stride + area->x1 * bpp;
+
+    display_mode_wait_scanline(next_line);
+
+    for (int32_t y = area->y1; y <= area->y2; y++) {
+        memcpy(dst, px_map, line_len);
+        dst += stride;
+        px_map += line_len;
+    }
+    DCache_Clean((uint32_t)(s_ctx->buf1 + area->y1 * stride), lv_area_get_height(area) * stride);
+
+    lv_display_flush_ready(disp);
+}
+
 static void flush_cb(lv_display_t *disp, const lv_area_t *area, uint8_t *px_map) {
-    (void)area;
+    refresh_activity();
+
+    if (s_ctx->beam_racing) {
+        flush_band(disp, area, px_map);
+        return;
+    }
+
+    if (s_ctx->rotation == 0 && display_mode_is_partial()) {
+        flush_area(disp, area, px_map);
+        return;
+    }
 
     if (!lv_display_flush_is_last(disp)) {
         lv_display_flush_ready(disp);
@@ -167,6 +281,13 @@ static void flush_cb(lv_display_t *disp, const lv_area_t *area, uint8_t *px_map)
 
     s_ctx->flip_index = !s_ctx->flip_index;
 
+    if (display_mode_is_partial()) {
+        /* The rotated frame goes out whole, the same way as dirty areas */
+        lv_area_t full = {0, 0, s_ctx->phys_width - 1, s_ctx->phys_height - 1};
+        flush_area(disp, &full, out_buffer);
+        return;
+    }
+
     display_mode_flip_buffer(out_buffer);
     s_ctx->flip_done = false;
     lv_thread_sync_wait(&s_ctx->flip_sync);
@@ -176,18 +297,26 @@ static void flush_cb(lv_display_t *disp, const lv_area_t *area, uint8_t *px_map)
 }
 
 int lv_port_init(uint16_t rotation) {
+    uint32_t boot_start = ameba_get_tick();
+
+    /* Panel reset and init tables run on their own task next to lv_init and the fs mount */
+    splash_init();
+    if (!display_mode_init_async(LV_COLOR_DEPTH)) {
+        display_mode_init_sync(LV_COLOR_DEPTH);
+    }
+
     lv_init();
     lv_tick_set_cb(ameba_get_tick);
 
     s_ctx = calloc(1, sizeof(lvgl_ctx_t));
     if (!s_ctx) {
+        display_mode_wait_ready();
         return -1;
     }
     s_ctx->color_depth = LV_COLOR_DEPTH;
     s_ctx->rotation    = rotation;
     s_ctx->flip_index  = 0;
 
-    display_init();  /* legacy: sets display up, registers vblank callback */
     s_ctx->flip_done = true;
     lv_thread_sync_init(&s_ctx->flip_sync);
     s_ctx->phys_width  = display_mode_get_width();
@@ -196,6 +325,9 @@ int lv_port_init(uint16_t rotation) {
     gfx_init();
     fs_init();
 
+    display_init();  /* legacy: waits for the display, registers vblank callback */
+    RTK_LOGI(LOG_TAG, "display ready %u ms after init\n", ameba_get_tick() - boot_start);
+
     get_disp_size();
 
     s_ctx->disp = lv_display_create(s_ctx->disp_width, s_ctx->disp_height);
@@ -206,8 +338,16 @@ int lv_port_init(uint16_t rotation) {
     }
 
     size_t buf_size = get_buf_size();
+#if LV_PORT_BEAM_RACING
+    s_ctx->beam_racing = s_ctx->rotation == 0 && !display_mode_is_partial();
+    if (!s_ctx->beam_racing) {
+        RTK_LOGW(LOG_TAG, "beam racing needs rotation 0 and a scanned-out panel, using two buffers\n");
+    }
+#endif
+    /* Beam racing: buf1 is the only frame buffer, buf2 holds one band */
+    size_t draw_size = s_ctx->beam_racing ? buf_size / LV_PORT_BEAM_BANDS : buf_size;
     s_ctx->buf1 = malloc(buf_size);
-    s_ctx->buf2 = malloc(buf_size);
+    s_ctx->buf2 = malloc(draw_size);
     if (!s_ctx->buf1 || !s_ctx->buf2) {
         free(s_ctx->buf1);
         free(s_ctx->buf2);
@@ -216,8 +356,21 @@ int lv_port_init(uint16_t rotation) {
         return -3;
     }
 
-    lv_display_set_buffers(s_ctx->disp, s_ctx->buf1, s_ctx->buf2,
-                           buf_size, LV_DISPLAY_RENDER_MODE_DIRECT);
+    if (s_ctx->beam_racing) {
+        /* Start from the splash so there is no black frame before the first bands */
+        if (display_mode_get_splash()) {
+            memcpy(s_ctx->buf1, display_mode_get_splash(), buf_size);
+        } else {
+            memset(s_ctx->buf1, 0, buf_size);
+        }
+        DCache_Clean((uint32_t)s_ctx->buf1, buf_size);
+        display_mode_flip_buffer(s_ctx->buf1);
+        lv_display_set_buffers(s_ctx->disp, s_ctx->buf2, NULL,
+                               draw_size, LV_DISPLAY_RENDER_MODE_PARTIAL);
+    } else {
+        lv_display_set_buffers(s_ctx->disp, s_ctx->buf1, s_ctx->buf2,
+                               buf_size, LV_DISPLAY_RENDER_MODE_DIRECT);
+    }
     lv_display_set_flush_cb(s_ctx->disp, flush_cb);
 
     if (s_ctx->rotation != 0) {
@@ -234,6 +387,9 @@ int lv_port_init(uint16_t rotation) {
         }
     }
 
+    s_ctx->full_refresh_rate = display_mode_get_refresh_rate();
+    s_ctx->last_flush_tick = ameba_get_tick();
+
     RTK_LOGI(LOG_TAG, "===== LVGL Init OK (rot=%u, %ux%u) =====\n",
              rotation, s_ctx->disp_width, s_ctx->disp_height);
     s_ctx->is_running = true;
@@ -247,6 +403,7 @@ void lv_port_run(void) {
 
     while (s_ctx->is_running) {
         uint32_t time_till_next = lv_task_handler();
+        refresh_check_idle();
 
         if(time_till_next == LV_NO_TIMER_READY)
             time_till_next = LV_DEF_REFR_PERIOD;
@@ -20,6 +20,44 @@
 
 #include <stdint.h>
 
+/*
+ * Render into the scanned-out frame buffer band by band, each band copied in
+ * right behind the LCDC scan line. Saves the second full frame buffer, needs
+ * rotation 0 and a panel the LCDC scans out (RGB or MIPI video mode).
+ */
+#ifndef LV_PORT_BEAM_RACING
+#define LV_PORT_BEAM_RACING     0
+#endif
+
+/* Bands per frame, the draw buffer is height / LV_PORT_BEAM_BANDS lines */
+#ifndef LV_PORT_BEAM_BANDS
+#define LV_PORT_BEAM_BANDS      8
+#endif
+
+/*
+ * Drop the panel refresh rate to LV_PORT_IDLE_REFRESH_HZ after this many ms
+ * without a flush, back to the full rate on the next one. 0 keeps the rate
+ * fixed. Only panels the LCDC can re-time at runtime (RGB) follow it.
+ */
+#ifndef LV_PORT_IDLE_REFRESH_MS
+#define LV_PORT_IDLE_REFRESH_MS 0
+#endif
+
+#ifndef LV_PORT_IDLE_REFRESH_HZ
+#define LV_PORT_IDLE_REFRESH_HZ 30
+#endif
+
+/*
+ * Boot splash on the romfs drive, shown from panel power-on until the first
+ * LVGL frame. It must be a raw frame, exactly panel width x height pixels in
+ * LV_COLOR_DEPTH with no LVGL .bin header, since the LCDC scans it out in
+ * place. Build the romfs image with mkromfs -a 64 so it starts aligned.
+ * Without the file the screen stays blank until then.
+ */
+#ifndef LV_PORT_SPLASH_PATH
+#define LV_PORT_SPLASH_PATH     "A:/splash.bin"
+#endif
+
 typedef void (*lv_port_demo_fn_t)(void);
 
 /**
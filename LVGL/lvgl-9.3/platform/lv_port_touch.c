@@ -23,30 +23,151 @@
 #define LOG_TAG     "LV-Touch"
 #define TOUCH_DEV   "cst328"
 
-static lv_indev_data_t s_touch_data = {
-    .state = LV_INDEV_STATE_RELEASED,
-    .point = {0, 0}
-};
+#define TOUCH_SLOTS         5
+#define TOUCH_ID_NONE       0xFF
+/* Samples a pointer may lag behind, power of two */
+#define TOUCH_SLOT_QUEUE    8
+
+typedef struct {
+    lv_point_t point;
+    lv_indev_state_t state;
+    uint32_t timestamp;
+} touch_sample_t;
+
+typedef struct {
+    uint8_t id;                 /* driver touch_id holding the slot, TOUCH_ID_NONE when free */
+    bool changed;               /* not handed to the gesture recognizers yet */
+    touch_sample_t latest;      /* newest sample, for the gesture recognizers */
+    touch_sample_t shown;       /* last sample handed to the slot's pointer, repeated while idle */
+    /* Samples of this finger only, so its pointer sees every press and release */
+    touch_sample_t queue[TOUCH_SLOT_QUEUE];
+    uint8_t head;
+    uint8_t tail;
+} touch_slot_t;
+
+static touch_slot_t s_slots[TOUCH_SLOTS];
+
+static void touch_slot_push(touch_slot_t *ts, const touch_sample_t *sample)
+{
+    if ((uint8_t)(ts->head - ts->tail) == TOUCH_SLOT_QUEUE) {
+        touch_sample_t *newest = &ts->queue[(uint8_t)(ts->head - 1) & (TOUCH_SLOT_QUEUE - 1)];
+
+        /* Full: fold a move into the previous one, else lose the oldest sample */
+        if (newest->state == sample->state) {
+            *newest = *sample;
+            return;
+        }
+        ts->tail++;
+    }
+
+    ts->queue[ts->head & (TOUCH_SLOT_QUEUE - 1)] = *sample;
+    ts->head++;
+}
 
-static void touch_event_cb(input_event_t *event)
+/* A finger keeps the first slot free at its press until it is released */
+static void touch_slot_update(const input_event_t *event)
 {
-    if (event->type != INPUT_EVENT_TOUCH) {
-        return;
+    const input_touch_data_t *touch = &event->data.touch;
+    int slot = -1;
+
+    for (int i = 0; i < TOUCH_SLOTS; i++) {
+        if (s_slots[i].id == touch->touch_id) {
+            slot = i;
+            break;
+        }
     }
 
-    s_touch_data.point.x = event->data.touch.x;
-    s_touch_data.point.y = event->data.touch.y;
-    s_touch_data.state   = event->data.touch.pressed
-                           ? LV_INDEV_STATE_PRESSED
-                           : LV_INDEV_STATE_RELEASED;
+    if (slot < 0) {
+        if (!touch->pressed) {
+            return;
+        }
+
+        for (int i = 0; i < TOUCH_SLOTS; i++) {
+            if (s_slots[i].id == TOUCH_ID_NONE) {
+                slot = i;
+                break;
+            }
+        }
+
+        if (slot < 0) {
+            return;
+        }
+    }
+
+    touch_slot_t *ts = &s_slots[slot];
+    ts->id               = touch->pressed ? touch->touch_id : TOUCH_ID_NONE;
+    ts->changed          = true;
+    ts->latest.point.x   = touch->x;
+    ts->latest.point.y   = touch->y;
+    ts->latest.state     = touch->pressed ? LV_INDEV_STATE_PRESSED : LV_INDEV_STATE_RELEASED;
+    ts->latest.timestamp = event->timestamp;
+
+    /* Slots past the pointers only feed the gesture recognizers */
+    if (slot < LV_PORT_TOUCH_POINTERS) {
+        touch_slot_push(ts, &ts->latest);
+    }
 }
 
+#if LV_USE_GESTURE_RECOGNITION
+/* All fingers go to the recognizers of the first pointer, down ones and those just lifted */
+static void touch_gesture_update(lv_indev_t *indev, lv_indev_data_t *data)
+{
+    lv_indev_touch_data_t touches[TOUCH_SLOTS];
+    uint16_t cnt = 0;
+
+    for (int i = 0; i < TOUCH_SLOTS; i++) {
+        touch_slot_t *ts = &s_slots[i];
+
+        if (ts->id == TOUCH_ID_NONE && !ts->changed) {
+            continue;
+        }
+
+        touches[cnt].point     = ts->latest.point;
+        touches[cnt].state     = ts->latest.state;
+        touches[cnt].id        = i;
+        touches[cnt].timestamp = ts->latest.timestamp;
+        ts->changed = false;
+        cnt++;
+    }
+
+    lv_indev_gesture_recognizers_update(indev, touches, cnt);
+    lv_indev_gesture_recognizers_set_data(indev, data);
+}
+#endif
+
 static void touch_read_cb(lv_indev_t *indev, lv_indev_data_t *data)
 {
-    (void)indev;
-    data->point.x = s_touch_data.point.x;
-    data->point.y = s_touch_data.point.y;
-    data->state   = s_touch_data.state;
+    int slot = (int)(intptr_t)lv_indev_get_user_data(indev);
+    touch_slot_t *ts = &s_slots[slot];
+    input_event_t event;
+    bool queued = false;
+
+    /* Sort the shared queue into the slots, whichever pointer reads first */
+    while (input_event_pop(&event)) {
+        if (event.type == INPUT_EVENT_TOUCH) {
+            touch_slot_update(&event);
+        }
+    }
+
+    /* One sample of this finger per read, LVGL calls back while continue_reading is set */
+    if (ts->head != ts->tail) {
+        ts->shown = ts->queue[ts->tail & (TOUCH_SLOT_QUEUE - 1)];
+        ts->tail++;
+        queued = true;
+    }
+
+    data->point.x          = ts->shown.point.x;
+    data->point.y          = ts->shown.point.y;
+    data->state            = ts->shown.state;
+    /* Same clock as lv_tick, the driver time if the sample came from the queue */
+    data->timestamp        = queued ? ts->shown.timestamp : lv_tick_get();
+    data->continue_reading = ts->head != ts->tail;
+
+#if LV_USE_GESTURE_RECOGNITION
+    if (slot == 0) {
+        touch_gesture_update(indev, data);
+    }
+#endif
 }
 
 void lv_port_touch_init(void)
@@ -54,7 +175,6 @@ void lv_port_touch_init(void)
     RTK_LOGI(LOG_TAG, "Touch init (%s)\n", TOUCH_DEV);
 
     input_manager_init();
-    input_set_global_callback(touch_event_cb);
 
     input_device_t *ts = input_get_device(TOUCH_DEV);
     RTK_LOGI(LOG_TAG, "ts=%p\n", ts);
@@ -84,15 +204,28 @@ void lv_port_touch_init(void)
 
 int lv_port_touch_register(void)
 {
-    lv_indev_t *indev = lv_indev_create();
-    if (!indev) {
-        RTK_LOGE(LOG_TAG, "Failed to create LVGL input device\n");
-        return -1;
+    for (int i = 0; i < TOUCH_SLOTS; i++) {
+        s_slots[i].id           = TOUCH_ID_NONE;
+        s_slots[i].latest.state = LV_INDEV_STATE_RELEASED;
+        s_slots[i].shown.state  = LV_INDEV_STATE_RELEASED;
+    }
+
+    /* Pointer i follows the finger in slot i */
+    for (int i = 0; i < LV_PORT_TOUCH_POINTERS && i < TOUCH_SLOTS; i++) {
+        lv_indev_t *indev = lv_indev_create();
+        if (!indev) {
+            RTK_LOGE(LOG_TAG, "Failed to create LVGL input device\n");
+            return -1;
+        }
+
+        lv_indev_set_type(indev, LV_INDEV_TYPE_POINTER);
+        lv_indev_set_user_data(indev, (void *)(intptr_t)i);
+        lv_indev_set_read_cb(indev, touch_read_cb);
     }
 
-    lv_indev_set_type(indev, LV_INDEV_TYPE_POINTER);
-    lv_indev_set_read_cb(indev, touch_read_cb);
+    /* The read callbacks drain the queue from now on */
+    input_event_queue_enable(true);
 
-    RTK_LOGI(LOG_TAG, "Touch registered to LVGL\n");
+    RTK_LOGI(LOG_TAG, "Touch registered to LVGL (%d pointers)\n", LV_PORT_TOUCH_POINTERS);
     return 0;
 }
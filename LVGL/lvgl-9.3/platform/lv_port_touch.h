@@ -18,11 +18,20 @@
 #ifndef AMEBA_UI_LVGL_PLATFORM_LV_PORT_TOUCH_H
 #define AMEBA_UI_LVGL_PLATFORM_LV_PORT_TOUCH_H
 
+/**
+ * Pointer input devices, one per finger in the order they touched down.
+ * Above 1 each finger can press its own object. Pinch and rotate gestures
+ * only need the first pointer when LV_USE_GESTURE_RECOGNITION is enabled.
+ */
+#ifndef LV_PORT_TOUCH_POINTERS
+#define LV_PORT_TOUCH_POINTERS  1
+#endif
+
 /** Initialize the touch hardware and input manager. */
 void lv_port_touch_init(void);
 
 /**
- * Register touch as an LVGL pointer input device.
+ * Register touch as LV_PORT_TOUCH_POINTERS LVGL pointer input devices.
  * @return 0 on success, -1 on failure.
  */
 int lv_port_touch_register(void);
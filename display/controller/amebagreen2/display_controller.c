@@ -13,6 +13,8 @@
  * limitations under the License.
  */
 
+#include <string.h>
+
 #include "os_wrapper.h"
 #include "ameba_soc.h"
 
@@ -88,6 +90,35 @@ void controller_do_page_flip(uint8_t *buffer) {
     }
 }
 
+bool controller_flush_area(uint8_t *buffer, uint16_t x1, uint16_t y1, uint16_t x2, uint16_t y2) {
+    if (!controller_context.initialized || !controller_context.panel) {
+        RTK_LOGS(LOG_TAG, RTK_LOG_INFO, "controller not initialized or no panel\n");
+        return false;
+    }
+
+    switch (controller_context.panel->desc->interface) {
+        case PANEL_IF_SPI:
+            return spi_only_flush_area(buffer, x1, y1, x2, y2);
+
+        default:
+            return false;
+    }
+}
+
+bool controller_flush_is_async(void) {
+    if (!controller_context.initialized || !controller_context.panel) {
+        return false;
+    }
+
+    switch (controller_context.panel->desc->interface) {
+        case PANEL_IF_SPI:
+            return true;
+
+        default:
+            return false;
+    }
+}
+
 void controller_register_vblank_callback(display_driver_callback_t *event) {
     if (!controller_context.initialized || !controller_context.panel) {
         RTK_LOGS(LOG_TAG, RTK_LOG_INFO, "controller not initialized or no panel\n");
@@ -106,4 +137,100 @@ void controller_register_vblank_callback(display_driver_callback_t *event) {
         default:
             break;
     }
-}
\ No newline at end of file
+}
+
+bool controller_wait_scanline(uint32_t line, uint32_t timeout_ms) {
+    if (!controller_context.initialized || !controller_context.panel) {
+        return false;
+    }
+
+    switch (controller_context.panel->desc->interface) {
+        case PANEL_IF_RGB:
+            return lcdc_rgb_wait_scanline(line, timeout_ms);
+
+        default:
+            return false;
+    }
+}
+
+void controller_get_stats(display_stats_t *stats) {
+    memset(stats, 0, sizeof(*stats));
+
+    if (!controller_context.initialized || !controller_context.panel) {
+        return;
+    }
+
+    switch (controller_context.panel->desc->interface) {
+        case PANEL_IF_RGB:
+            lcdc_rgb_get_stats(stats);
+            break;
+
+        default:
+            break;
+    }
+}
+
+bool controller_is_congested(void) {
+    if (!controller_context.initialized || !controller_context.panel) {
+        return false;
+    }
+
+    switch (controller_context.panel->desc->interface) {
+        case PANEL_IF_RGB:
+            return lcdc_rgb_is_congested();
+
+        default:
+            return false;
+    }
+}
+
+bool controller_set_refresh_rate(uint32_t rate) {
+    if (!controller_context.initialized || !controller_context.panel) {
+        return false;
+    }
+
+    switch (controller_context.panel->desc->interface) {
+        case PANEL_IF_RGB:
+            return lcdc_rgb_set_refresh_rate(rate);
+
+        default:
+            return false;
+    }
+}
+
+uint32_t controller_get_refresh_rate(void) {
+    if (!controller_context.initialized || !controller_context.panel) {
+        return 0;
+    }
+
+    switch (controller_context.panel->desc->interface) {
+        case PANEL_IF_RGB:
+            return lcdc_rgb_get_refresh_rate();
+
+        default:
+            return 0;
+    }
+}
+
+uint32_t controller_get_plane_count(void) {
+    if (!controller_context.initialized || !controller_context.panel) {
+        return 0;
+    }
+
+    // the RGB path scans out a single DMA image, SPI panels hold one frame.
+    return 1;
+}
+
+bool controller_set_plane(uint32_t plane, const display_plane_t *config) {
+    if (!controller_context.initialized || !controller_context.panel) {
+        RTK_LOGS(LOG_TAG, RTK_LOG_INFO, "controller not initialized or no panel\n");
+        return false;
+    }
+
+    (void) plane;
+    (void) config;
+
+    RTK_LOGS(LOG_TAG, RTK_LOG_ERROR, "no extra planes on interface: %d\n",
+             controller_context.panel->desc->interface);
+    return false;
+}
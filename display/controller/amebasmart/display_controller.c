@@ -13,6 +13,8 @@
  * limitations under the License.
  */
 
+#include <string.h>
+
 #include "os_wrapper.h"
 #include "ameba_soc.h"
 
@@ -88,6 +90,41 @@ void controller_do_page_flip(uint8_t *buffer) {
     }
 }
 
+bool controller_flush_area(uint8_t *buffer, uint16_t x1, uint16_t y1, uint16_t x2, uint16_t y2) {
+    if (!controller_context.initialized || !controller_context.panel) {
+        RTK_LOGS(LOG_TAG, RTK_LOG_INFO, "controller not initialized or no panel\n");
+        return false;
+    }
+
+    switch (controller_context.panel->desc->interface) {
+        case PANEL_IF_MIPI_DSI:
+            return lcdc_mipi_flush_area(buffer, x1, y1, x2, y2);
+
+        case PANEL_IF_SPI:
+            return spi_only_flush_area(buffer, x1, y1, x2, y2);
+
+        default:
+            return false;
+    }
+}
+
+bool controller_flush_is_async(void) {
+    if (!controller_context.initialized || !controller_context.panel) {
+        return false;
+    }
+
+    switch (controller_context.panel->desc->interface) {
+        case PANEL_IF_MIPI_DSI:
+            return false;
+
+        case PANEL_IF_SPI:
+            return true;
+
+        default:
+            return false;
+    }
+}
+
 void controller_register_vblank_callback(display_driver_callback_t *event) {
     if (!controller_context.initialized || !controller_context.panel) {
         RTK_LOGS(LOG_TAG, RTK_LOG_INFO, "controller not initialized or no panel\n");
@@ -106,4 +143,94 @@ void controller_register_vblank_callback(display_driver_callback_t *event) {
         default:
             break;
     }
-}
\ No newline at end of file
+}
+
+bool controller_wait_scanline(uint32_t line, uint32_t timeout_ms) {
+    if (!controller_context.initialized || !controller_context.panel) {
+        return false;
+    }
+
+    switch (controller_context.panel->desc->interface) {
+        case PANEL_IF_MIPI_DSI:
+            return lcdc_mipi_wait_scanline(line, timeout_ms);
+
+        default:
+            return false;
+    }
+}
+
+void controller_get_stats(display_stats_t *stats) {
+    memset(stats, 0, sizeof(*stats));
+
+    if (!controller_context.initialized || !controller_context.panel) {
+        return;
+    }
+
+    switch (controller_context.panel->desc->interface) {
+        case PANEL_IF_MIPI_DSI:
+            lcdc_mipi_get_stats(stats);
+            break;
+
+        default:
+            break;
+    }
+}
+
+bool controller_is_congested(void) {
+    if (!controller_context.initialized || !controller_context.panel) {
+        return false;
+    }
+
+    switch (controller_context.panel->desc->interface) {
+        case PANEL_IF_MIPI_DSI:
+            return lcdc_mipi_is_congested();
+
+        default:
+            return false;
+    }
+}
+
+// the DSI lane clock is derived from the frame rate in mipi_init, video mode panels
+// keep the rate they were brought up with.
+bool controller_set_refresh_rate(uint32_t rate) {
+    (void)rate;
+    return false;
+}
+
+uint32_t controller_get_refresh_rate(void) {
+    if (!controller_context.initialized || !controller_context.panel ||
+        controller_context.panel->desc->interface != PANEL_IF_MIPI_DSI) {
+        return 0;
+    }
+
+    return controller_context.panel->desc->timing.clock_frequency;
+}
+
+uint32_t controller_get_plane_count(void) {
+    if (!controller_context.initialized || !controller_context.panel) {
+        return 0;
+    }
+
+    switch (controller_context.panel->desc->interface) {
+        case PANEL_IF_MIPI_DSI:
+            return lcdc_mipi_get_plane_count();
+
+        default:
+            return 1;
+    }
+}
+
+bool controller_set_plane(uint32_t plane, const display_plane_t *config) {
+    if (!controller_context.initialized || !controller_context.panel) {
+        RTK_LOGS(LOG_TAG, RTK_LOG_INFO, "controller not initialized or no panel\n");
+        return false;
+    }
+
+    switch (controller_context.panel->desc->interface) {
+        case PANEL_IF_MIPI_DSI:
+            return lcdc_mipi_set_plane(plane, config);
+
+        default:
+            return false;
+    }
+}
@@ -43,8 +43,50 @@ typedef struct {
     void (*vblank_handler)(void *user_data);
 } display_driver_callback_t;
 
+// plane 0 is the primary plane fed by controller_do_page_flip, planes above
+// it are extra hardware layers blended by the controller at scan-out.
+#define DISPLAY_PLANE_PRIMARY 0
+
+typedef struct {
+    bool enable;
+    uint8_t *buffer;        // width * height pixels, no line padding
+    lcd_format_t format;
+    uint16_t x;
+    uint16_t y;
+    uint16_t width;
+    uint16_t height;
+    uint8_t alpha;          // global alpha, 255 is opaque
+} display_plane_t;
+
+typedef struct {
+    uint32_t frames;        // frame done interrupts since init
+    uint32_t underflows;    // LCDC DMA underflows since init
+    uint32_t burst_size;    // current LCDC DMA burst setting
+    uint32_t bandwidth;     // estimated scan-out read rate in bytes per second
+    bool congested;         // underflowed in the last frames with the burst already at its max
+} display_stats_t;
+
 bool controller_init_with_panel(int32_t color_depth, panel_dev_t *panel);
 void controller_do_page_flip(uint8_t *buffer);
+// partial update of a full frame buffer, false if the interface can only flip whole frames.
+bool controller_flush_area(uint8_t *buffer, uint16_t x1, uint16_t y1, uint16_t x2, uint16_t y2);
+// true if controller_flush_area returns with the transfer in flight and reports its end through
+// the vblank callback, false if the area is sent by the time it returns.
+bool controller_flush_is_async(void);
 void controller_register_vblank_callback(display_driver_callback_t *event);
+// block until the scan-out reaches line, false if the interface has no line interrupt.
+bool controller_wait_scanline(uint32_t line, uint32_t timeout_ms);
+// scan-out counters and bandwidth estimate, all zero for interfaces without an LCDC.
+void controller_get_stats(display_stats_t *stats);
+// display_stats_t.congested alone, cheap enough to ask before every bus master job.
+bool controller_is_congested(void);
+// switch the scan-out rate at the next frame boundary, at most the panel timing rate.
+bool controller_set_refresh_rate(uint32_t rate);
+// current scan-out rate in Hz, 0 if the interface has no fixed refresh.
+uint32_t controller_get_refresh_rate(void);
+// number of planes including the primary one.
+uint32_t controller_get_plane_count(void);
+// assign a buffer and geometry to an extra plane, applied at the next frame.
+bool controller_set_plane(uint32_t plane, const display_plane_t *config);
 
 #endif // AMEBA_UI_DISPLAY_CONTROLLER_INCLUDE_DISPLAY_CONTROLLER_H
\ No newline at end of file
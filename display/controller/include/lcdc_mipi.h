@@ -25,6 +25,14 @@
 
 bool lcdc_mipi_controller_init(int32_t color_depth, panel_dev_t *panel);
 void lcdc_mipi_do_page_flip(uint8_t *buffer);
+// command mode panels only, writes the area with DCS memory writes after the next TE.
+// Synchronous, the vblank callback is not called.
+bool lcdc_mipi_flush_area(uint8_t *buffer, uint16_t x1, uint16_t y1, uint16_t x2, uint16_t y2);
 void lcdc_mipi_register_vblank_callback(display_driver_callback_t *event);
+bool lcdc_mipi_wait_scanline(uint32_t line, uint32_t timeout_ms);
+void lcdc_mipi_get_stats(display_stats_t *stats);
+bool lcdc_mipi_is_congested(void);
+uint32_t lcdc_mipi_get_plane_count(void);
+bool lcdc_mipi_set_plane(uint32_t plane, const display_plane_t *config);
 
 #endif // AMEBA_UI_DISPLAY_CONTROLLER_INCLUDE_LCDC_MIPI_H
\ No newline at end of file
@@ -26,5 +26,10 @@
 bool lcdc_rgb_controller_init(int32_t color_depth, panel_dev_t *panel);
 void lcdc_rgb_do_page_flip(uint8_t *buffer);
 void lcdc_rgb_register_vblank_callback(display_driver_callback_t *event);
+bool lcdc_rgb_wait_scanline(uint32_t line, uint32_t timeout_ms);
+void lcdc_rgb_get_stats(display_stats_t *stats);
+bool lcdc_rgb_is_congested(void);
+bool lcdc_rgb_set_refresh_rate(uint32_t rate);
+uint32_t lcdc_rgb_get_refresh_rate(void);
 
 #endif // AMEBA_UI_DISPLAY_CONTROLLER_INCLUDE_LCDC_RGB_H
\ No newline at end of file
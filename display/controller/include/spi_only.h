@@ -23,8 +23,24 @@
 
 #include "display_controller.h"
 
+// pixel clock of the 4-wire bus once the panel is initialized
+#ifndef SPI_ONLY_BUS_FREQUENCY
+#define SPI_ONLY_BUS_FREQUENCY 50000000
+#endif
+
+// size of each of the two line buffers pixels are converted into on the way to the bus
+#ifndef SPI_ONLY_LINE_BUF_SIZE
+#define SPI_ONLY_LINE_BUF_SIZE 4096
+#endif
+
+// the bus always carries big-endian RGB565
+#define SPI_ONLY_BUS_BYTES_PER_PIXEL 2
+
 bool spi_only_controller_init(int32_t color_depth, panel_dev_t *panel);
 void spi_only_do_page_flip(uint8_t *buffer);
+// send the area (x1,y1)-(x2,y2) of a full RGB565 or XRGB8888 frame buffer, returns once the
+// last chunk is on the bus and the vblank callback fires when it is out.
+bool spi_only_flush_area(uint8_t *buffer, uint16_t x1, uint16_t y1, uint16_t x2, uint16_t y2);
 void spi_only_register_vblank_callback(display_driver_callback_t *event);
 
 #endif // AMEBA_UI_DISPLAY_CONTROLLER_INCLUDE_SPI_ONLY_H
\ No newline at end of file
@@ -15,6 +15,7 @@
 
 #include "os_wrapper.h"
 #include "ameba_soc.h"
+#include "gpio_irq_api.h"
 
 #include "panel_manager.h"
 #include "lcdc_mipi.h"
@@ -37,6 +38,32 @@
 
 #define MIPI_DSI_RTNI                               2//4
 
+#define LCDC_MIPI_PLANE_NUM                         3
+
+// step the DMA burst up through lcdc_burst_sizes on underflowing frames
+#ifndef LCDC_DMA_AUTO_TUNE
+#define LCDC_DMA_AUTO_TUNE                          1
+#endif
+
+// index into lcdc_burst_sizes the LCDC starts with, the largest one
+#define LCDC_DMA_BURST_DEFAULT                      2
+// frames the bus stays reported congested after an underflow
+#define LCDC_CONGESTION_FRAMES                      30
+
+#define DCS_SET_COLUMN_ADDRESS                      0x2A
+#define DCS_SET_PAGE_ADDRESS                        0x2B
+#define DCS_WRITE_MEMORY_START                      0x2C
+#define DCS_WRITE_MEMORY_CONTINUE                   0x3C
+#define DCS_SET_TEAR_ON                             0x35
+
+/* pixel bytes per long packet, a multiple of both 2 and 3 below the packet memory */
+#define DSI_CMD_PIXEL_PAYLOAD                       126
+#define DSI_CMD_TX_TIMEOUT_MS                       10
+/* longest a dirty area may hold the caller, several TE periods */
+#define DSI_CMD_FLUSH_TIMEOUT_MS                    200
+/* two frames at 30 Hz, after that the TE line is taken as missing */
+#define DSI_TE_TIMEOUT_MS                           66
+
 typedef struct {
     const uint8_t (*table)[32];
     uint32_t table_size;
@@ -64,10 +91,38 @@ typedef struct {
     void *user_data;
 
     uint32_t buffer_size;
+
+    // command mode, the panel keeps the frame and only dirty areas are written.
+    bool command_mode;
+    gpio_irq_t te_irq;
+    rtos_sema_t te_sema;
+    rtos_sema_t tx_sema;
+    uint8_t pixel_buf[DSI_CMD_PIXEL_PAYLOAD];
+
+    // scan line waits, the line interrupt is only unmasked while one is pending
+    uint32_t line_target;
+    rtos_sema_t line_sema;
+    volatile bool line_waiting;
+
+    // telemetry, updated from the irq
+    volatile uint32_t frame_count;
+    volatile uint32_t underflow_count;
+    volatile uint32_t burst_size;
+    uint32_t burst_index;
+    volatile uint32_t congested_frames;
+    volatile bool underflow_pending;
+    uint32_t plane_bytes[LCDC_MIPI_PLANE_NUM];
 } lcdc_context_t;
 
 static lcdc_context_t lcdc_context = {0};
 
+// the LCDC_LAYER_BURSTSIZE_* values are not consecutive steps, smallest first
+static const uint32_t lcdc_burst_sizes[] = {
+    LCDC_LAYER_BURSTSIZE_1X64BYTES,
+    LCDC_LAYER_BURSTSIZE_2X64BYTES,
+    LCDC_LAYER_BURSTSIZE_4X64BYTES,
+};
+
 static struct {
     uint32_t irq_num;
     uint32_t irq_priority;
@@ -92,6 +147,9 @@ static void mipi_dsi_isr(void)
 
     if (ints & MIPI_BIT_CMD_TXDONE) {
         lcdc_context.panel_ctx.send_busy = 0;
+        if (lcdc_context.tx_sema) {
+            rtos_sema_give(lcdc_context.tx_sema);
+        }
         ints &= ~MIPI_BIT_CMD_TXDONE;
     }
 
@@ -183,6 +241,24 @@ static void dsi_send_dcs(uint8_t cmd,
     MIPI_DSI_CMD_Send(MIPI, MIPI_DSI_DCS_LONG_WRITE, payload_len, 0);
 }
 
+// block on the TXDONE interrupt, the task sleeps while the packet is on the link.
+static bool dsi_send_dcs_wait(uint8_t cmd, uint8_t payload_len, const uint8_t *para_list)
+{
+    // a TXDONE that came after an earlier timeout must not end this wait
+    rtos_sema_take(lcdc_context.tx_sema, 0);
+
+    lcdc_context.panel_ctx.send_busy = 1;
+    dsi_send_dcs(cmd, payload_len, para_list);
+
+    if (rtos_sema_take(lcdc_context.tx_sema, DSI_CMD_TX_TIMEOUT_MS) != RTK_SUCCESS) {
+        RTK_LOGS(LOG_TAG, RTK_LOG_ERROR, "DSI: cmd 0x%02x tx timeout\n", cmd);
+        lcdc_context.panel_ctx.send_busy = 0;
+        return false;
+    }
+
+    return true;
+}
+
 static uint8_t panel_send_next_cmd(void)
 {
     panel_cmd_ctx_t *ctx = &lcdc_context.panel_ctx;
@@ -298,7 +374,10 @@ static void lcdc_display_init(const panel_timing_t *panel_timing)
 
     LCDC_Init(LCDC, &lcdc_context.lcdc_init_struct);
 
-    LCDC_DMAModeConfig(LCDC, LCDC_LAYER_BURSTSIZE_4X64BYTES);
+    lcdc_context.burst_index = LCDC_DMA_BURST_DEFAULT;
+    lcdc_context.burst_size = lcdc_burst_sizes[lcdc_context.burst_index];
+    lcdc_context.plane_bytes[DISPLAY_PLANE_PRIMARY] = lcdc_context.buffer_size;
+    LCDC_DMAModeConfig(LCDC, lcdc_context.burst_size);
     LCDC_DMADebugConfig(LCDC, LCDC_DMA_OUT_DISABLE, NULL);
 
     LCDC_Cmd(LCDC, ENABLE);
@@ -369,6 +448,29 @@ static bool mipi_init(const panel_timing_t *panel_timing) {
     return true;
 }
 
+// called at frame done, applies the auto tune policy to the underflows of the last frame.
+static void lcdc_update_burst(void) {
+    if (!lcdc_context.underflow_pending) {
+        if (lcdc_context.congested_frames) {
+            lcdc_context.congested_frames--;
+        }
+        return;
+    }
+    lcdc_context.underflow_pending = false;
+
+#if LCDC_DMA_AUTO_TUNE
+    if (lcdc_context.burst_index + 1 < sizeof(lcdc_burst_sizes) / sizeof(lcdc_burst_sizes[0])) {
+        lcdc_context.burst_index++;
+        lcdc_context.burst_size = lcdc_burst_sizes[lcdc_context.burst_index];
+        LCDC_DMAModeConfig(LCDC, lcdc_context.burst_size);
+        RTK_LOGS(LOG_TAG, RTK_LOG_WARN, "underflow, dma burst raised to %d\n", lcdc_context.burst_size);
+        return;
+    }
+#endif
+
+    lcdc_context.congested_frames = LCDC_CONGESTION_FRAMES;
+}
+
 static void lcdc_irq_handler(void) {
     volatile uint32_t int_status = LCDC_GetINTStatus(LCDC);
     LCDC_ClearINT(LCDC, int_status);
@@ -377,6 +479,8 @@ static void lcdc_irq_handler(void) {
 
     if (int_status & LCDC_BIT_LCD_FRD_INTS) {
         RTK_LOGS(LOG_TAG, RTK_LOG_DEBUG, "irq: frame done\n");
+        lcdc_context.frame_count++;
+        lcdc_update_burst();
         if (lcdc_context.callback) {
             lcdc_context.callback->vblank_handler(lcdc_context.user_data);
         }
@@ -384,24 +488,30 @@ static void lcdc_irq_handler(void) {
 
     if (int_status & LCDC_BIT_LCD_LIN_INTS) {
         RTK_LOGS(LOG_TAG, RTK_LOG_DEBUG, "irq: line hit\n");
+
+        LCDC_INTConfig(LCDC, LCDC_BIT_LCD_LIN_INTEN, DISABLE);
+        if (lcdc_context.line_waiting) {
+            lcdc_context.line_waiting = false;
+            rtos_sema_give(lcdc_context.line_sema);
+        }
     }
 
     if (int_status & LCDC_BIT_DMA_UN_INTS) {
         RTK_LOGS(LOG_TAG, RTK_LOG_ERROR, "irq: dma underflow\n");
+        lcdc_context.underflow_count++;
+        lcdc_context.underflow_pending = true;
     }
 }
 
-static void lcdc_init_irq(lcd_timing_t *timing) {
+static void lcdc_init_irq(void) {
     // register interrupt
     InterruptRegister((IRQ_FUN)lcdc_irq_handler, lcdc_irq_info.irq_num,
                       (uint32_t)LCDC, lcdc_irq_info.irq_priority);
     InterruptEn(lcdc_irq_info.irq_num, lcdc_irq_info.irq_priority);
 
-    // enable interrupt
-    int line_intr_position = timing->height * 5 / 6;  // line interrupt position
-    LCDC_LineINTPosConfig(LCDC, line_intr_position);
-    LCDC_INTConfig(LCDC, LCDC_BIT_LCD_FRD_INTEN | LCDC_BIT_DMA_UN_INTEN |
-                   LCDC_BIT_LCD_LIN_INTEN, ENABLE);
+    // enable interrupt, the line interrupt is armed by scan line waits only
+    rtos_sema_create(&lcdc_context.line_sema, 0, 1);
+    LCDC_INTConfig(LCDC, LCDC_BIT_LCD_FRD_INTEN | LCDC_BIT_DMA_UN_INTEN, ENABLE);
 }
 
 static bool mipi_controller_init(const panel_timing_t *panel_timing,
@@ -410,11 +520,45 @@ static bool mipi_controller_init(const panel_timing_t *panel_timing,
 
     dsi_panel_push_table(table_size, table);
 
-    lcdc_display_init(panel_timing);
+    // command mode panels stay on the LP command link, the LCDC never scans out.
+    if (!lcdc_context.command_mode) {
+        lcdc_display_init(panel_timing);
+    }
 
     return true;
 }
 
+static void dsi_te_irq_handler(uint32_t id, gpio_irq_event event)
+{
+    (void) id;
+    (void) event;
+
+    rtos_sema_give(lcdc_context.te_sema);
+}
+
+static void dsi_te_init(panel_dev_t *panel)
+{
+    panel_gpio_config_t *gpio_config = panel->desc->gpio_config;
+
+    if (!gpio_config || gpio_config->te_pin == 0xFFFFFFFF) {
+        RTK_LOGS(LOG_TAG, RTK_LOG_WARN, "DSI: no TE pin, command mode updates may tear\n");
+        return;
+    }
+
+    if (rtos_sema_create(&lcdc_context.te_sema, 0, 1) != RTK_SUCCESS) {
+        RTK_LOGS(LOG_TAG, RTK_LOG_ERROR, "DSI: failed to create TE semaphore\n");
+        return;
+    }
+
+    // TE on V-blanking only.
+    uint8_t mode = 0;
+    dsi_send_dcs_wait(DCS_SET_TEAR_ON, 1, &mode);
+
+    gpio_irq_init(&lcdc_context.te_irq, gpio_config->te_pin, dsi_te_irq_handler, 0);
+    gpio_irq_set(&lcdc_context.te_irq, IRQ_RISE, 1);
+    gpio_irq_enable(&lcdc_context.te_irq);
+}
+
 
 
 bool lcdc_mipi_controller_init(int32_t color_depth, panel_dev_t *panel) {
@@ -470,6 +614,8 @@ bool lcdc_mipi_controller_init(int32_t color_depth, panel_dev_t *panel) {
 
     lcdc_mipi_enable_clk();
 
+    lcdc_context.command_mode = panel->desc->command_mode;
+
     uint32_t table_size = panel->desc->init_cmd_count;
     const uint8_t (*table)[32] = panel->desc->init_cmds;
 
@@ -477,7 +623,16 @@ bool lcdc_mipi_controller_init(int32_t color_depth, panel_dev_t *panel) {
         return false;
     }
 
-    lcdc_init_irq(&lcdc_context.timing);
+    if (lcdc_context.command_mode) {
+        // dirty areas go out packet by packet, each one ends with TXDONE
+        if (rtos_sema_create(&lcdc_context.tx_sema, 0, 1) != RTK_SUCCESS) {
+            RTK_LOGS(LOG_TAG, RTK_LOG_ERROR, "DSI: failed to create tx semaphore\n");
+            return false;
+        }
+        dsi_te_init(panel);
+    } else {
+        lcdc_init_irq();
+    }
     lcdc_context.initialized = true;
     lcdc_context.lcdc_enabled = false;
 
@@ -493,6 +648,11 @@ void lcdc_mipi_do_page_flip(uint8_t *buffer) {
         return;
     }
 
+    if (lcdc_context.command_mode) {
+        lcdc_mipi_flush_area(buffer, 0, 0, lcdc_context.timing.width - 1, lcdc_context.timing.height - 1);
+        return;
+    }
+
     DCache_Clean((u32)buffer, lcdc_context.buffer_size);
 
     lcdc_context.lcdc_init_struct.layerx[0].LCDC_LayerImgBaseAddr = (u32)buffer;
@@ -506,6 +666,221 @@ void lcdc_mipi_do_page_flip(uint8_t *buffer) {
     }
 }
 
+// pack pixels the way DCS memory writes take them, RGB888 as R,G,B and RGB565
+// big-endian. The panel init table has to set the matching COLMOD.
+static uint32_t dsi_pack_pixels(uint8_t *dst, const uint8_t *src, uint32_t count)
+{
+    uint32_t i;
+
+    switch (lcdc_context.in_format) {
+    case LCD_FORMAT_RGB565:
+        for (i = 0; i < count; i++) {
+            dst[2 * i] = src[2 * i + 1];
+            dst[2 * i + 1] = src[2 * i];
+        }
+        return count * 2;
+    case LCD_FORMAT_RGB888:
+        for (i = 0; i < count; i++) {
+            dst[3 * i] = src[3 * i + 2];
+            dst[3 * i + 1] = src[3 * i + 1];
+            dst[3 * i + 2] = src[3 * i];
+        }
+        return count * 3;
+    case LCD_FORMAT_ARGB8888:
+    default:
+        for (i = 0; i < count; i++) {
+            dst[3 * i] = src[4 * i + 2];
+            dst[3 * i + 1] = src[4 * i + 1];
+            dst[3 * i + 2] = src[4 * i];
+        }
+        return count * 3;
+    }
+}
+
+bool lcdc_mipi_flush_area(uint8_t *buffer, uint16_t x1, uint16_t y1, uint16_t x2, uint16_t y2) {
+    if (!lcdc_context.initialized || !lcdc_context.command_mode) {
+        return false;
+    }
+
+    if (x1 > x2 || y1 > y2 || x2 >= lcdc_context.timing.width || y2 >= lcdc_context.timing.height) {
+        RTK_LOGS(LOG_TAG, RTK_LOG_ERROR, "invalid area (%d,%d)-(%d,%d)\n", x1, y1, x2, y2);
+        return false;
+    }
+
+    uint32_t src_bpp = lcdc_context.in_format == LCD_FORMAT_RGB565 ? 2 :
+                       lcdc_context.in_format == LCD_FORMAT_RGB888 ? 3 : 4;
+    uint32_t dst_bpp = lcdc_context.in_format == LCD_FORMAT_RGB565 ? 2 : 3;
+    uint32_t pixels_per_packet = DSI_CMD_PIXEL_PAYLOAD / dst_bpp;
+    uint8_t window[4];
+    uint8_t cmd = DCS_WRITE_MEMORY_START;
+    uint32_t start;
+
+    // start right after a TE edge so the writes stay behind the panel scan.
+    if (lcdc_context.te_sema) {
+        rtos_sema_take(lcdc_context.te_sema, 0);
+        if (rtos_sema_take(lcdc_context.te_sema, DSI_TE_TIMEOUT_MS) != RTK_SUCCESS) {
+            RTK_LOGS(LOG_TAG, RTK_LOG_WARN, "DSI: TE timeout\n");
+        }
+    }
+
+    start = rtos_time_get_current_system_time_ms();
+
+    window[0] = x1 >> 8;
+    window[1] = x1 & 0xFF;
+    window[2] = x2 >> 8;
+    window[3] = x2 & 0xFF;
+    dsi_send_dcs_wait(DCS_SET_COLUMN_ADDRESS, 4, window);
+
+    window[0] = y1 >> 8;
+    window[1] = y1 & 0xFF;
+    window[2] = y2 >> 8;
+    window[3] = y2 & 0xFF;
+    dsi_send_dcs_wait(DCS_SET_PAGE_ADDRESS, 4, window);
+
+    for (uint32_t y = y1; y <= y2; y++) {
+        const uint8_t *row = buffer + (y * lcdc_context.timing.width + x1) * src_bpp;
+        uint32_t left = x2 - x1 + 1;
+
+        // a link that crawls must not hold the UI task for seconds, the rest of the area is dropped
+        if (rtos_time_get_current_system_time_ms() - start > DSI_CMD_FLUSH_TIMEOUT_MS) {
+            RTK_LOGS(LOG_TAG, RTK_LOG_ERROR, "DSI: flush timeout at row %d of (%d,%d)-(%d,%d)\n",
+                     y, x1, y1, x2, y2);
+            return false;
+        }
+
+        while (left) {
+            uint32_t count = MIN(left, pixels_per_packet);
+            uint32_t len = dsi_pack_pixels(lcdc_context.pixel_buf, row, count);
+
+            if (!dsi_send_dcs_wait(cmd, len, lcdc_context.pixel_buf)) {
+                return false;
+            }
+
+            cmd = DCS_WRITE_MEMORY_CONTINUE;
+            row += count * src_bpp;
+            left -= count;
+        }
+    }
+
+    // the area is on the panel already, the caller completes the flush itself
+    // (the vblank callback is for interrupt context only).
+    return true;
+}
+
 void lcdc_mipi_register_vblank_callback(display_driver_callback_t *event) {
     lcdc_context.callback = event;
-}
\ No newline at end of file
+}
+
+uint32_t lcdc_mipi_get_plane_count(void) {
+    // command mode panels take DCS writes of the primary frame, the LCDC never blends.
+    return lcdc_context.command_mode ? 1 : LCDC_MIPI_PLANE_NUM;
+}
+
+bool lcdc_mipi_set_plane(uint32_t plane, const display_plane_t *config) {
+    if (!lcdc_context.initialized || !lcdc_context.panel) {
+        RTK_LOGS(LOG_TAG, RTK_LOG_INFO, "lcdc not initialized or no panel\n");
+        return false;
+    }
+
+    // the primary layer belongs to page flips.
+    if (plane == DISPLAY_PLANE_PRIMARY || plane >= lcdc_mipi_get_plane_count() || !config) {
+        RTK_LOGS(LOG_TAG, RTK_LOG_ERROR, "invalid plane %d\n", plane);
+        return false;
+    }
+
+    LCDC_LayerConfigTypeDef *layer = &lcdc_context.lcdc_init_struct.layerx[plane];
+
+    if (!config->enable) {
+        layer->LCDC_LayerEn = DISABLE;
+        lcdc_context.plane_bytes[plane] = 0;
+    } else {
+        uint32_t bytes_per_pixel;
+        uint32_t image_format;
+
+        switch (config->format) {
+        case LCD_FORMAT_RGB565:
+            image_format = LCDC_LAYER_IMG_FORMAT_RGB565;
+            bytes_per_pixel = 2;
+            break;
+        case LCD_FORMAT_RGB888:
+            image_format = LCDC_LAYER_IMG_FORMAT_RGB888;
+            bytes_per_pixel = 3;
+            break;
+        case LCD_FORMAT_ARGB8888:
+        default:
+            image_format = LCDC_LAYER_IMG_FORMAT_ARGB8888;
+            bytes_per_pixel = 4;
+            break;
+        }
+
+        if (!config->buffer || !config->width || !config->height ||
+            config->x + config->width > lcdc_context.timing.width ||
+            config->y + config->height > lcdc_context.timing.height) {
+            RTK_LOGS(LOG_TAG, RTK_LOG_ERROR, "plane %d out of screen\n", plane);
+            return false;
+        }
+
+        DCache_Clean((u32)config->buffer, config->width * config->height * bytes_per_pixel);
+
+        layer->LCDC_LayerEn = ENABLE;
+        layer->LCDC_LayerImgFormat = image_format;
+        layer->LCDC_LayerImgBaseAddr = (u32)config->buffer;
+        layer->LCDC_LayerHorizontalStart = config->x + 1;/*1-based*/
+        layer->LCDC_LayerHorizontalStop = config->x + config->width;
+        layer->LCDC_LayerVerticalStart = config->y + 1;/*1-based*/
+        layer->LCDC_LayerVerticalStop = config->y + config->height;
+        layer->LCDC_LayerConstAlpha = config->alpha;
+        lcdc_context.plane_bytes[plane] = config->width * config->height * bytes_per_pixel;
+    }
+
+    // latched with the shadow registers at the next frame, like a page flip.
+    LCDC_LayerConfig(LCDC, LCDC_LAYER_LAYER1 + plane, layer);
+    LCDC_TrigerSHWReload(LCDC);
+
+    return true;
+}
+
+bool lcdc_mipi_wait_scanline(uint32_t line, uint32_t timeout_ms) {
+    if (!lcdc_context.lcdc_enabled || !lcdc_context.line_sema || line >= lcdc_context.timing.height) {
+        return false;
+    }
+
+    // move the line interrupt with it masked, a hit at the old position must not end the wait
+    LCDC_INTConfig(LCDC, LCDC_BIT_LCD_LIN_INTEN, DISABLE);
+    LCDC_LineINTPosConfig(LCDC, line);
+    LCDC_ClearINT(LCDC, LCDC_BIT_LCD_LIN_INTS);
+    rtos_sema_take(lcdc_context.line_sema, 0);
+    lcdc_context.line_target = line;
+    lcdc_context.line_waiting = true;
+    LCDC_INTConfig(LCDC, LCDC_BIT_LCD_LIN_INTEN, ENABLE);
+
+    if (rtos_sema_take(lcdc_context.line_sema, timeout_ms) != RTK_SUCCESS) {
+        LCDC_INTConfig(LCDC, LCDC_BIT_LCD_LIN_INTEN, DISABLE);
+        lcdc_context.line_waiting = false;
+        return false;
+    }
+
+    return true;
+}
+
+void lcdc_mipi_get_stats(display_stats_t *stats) {
+    uint32_t frame_bytes = 0;
+
+    // command mode panels are written over DSI, the LCDC doesn't scan out
+    if (!lcdc_context.command_mode) {
+        for (uint32_t i = 0; i < LCDC_MIPI_PLANE_NUM; i++) {
+            frame_bytes += lcdc_context.plane_bytes[i];
+        }
+    }
+
+    stats->frames = lcdc_context.frame_count;
+    stats->underflows = lcdc_context.underflow_count;
+    stats->burst_size = lcdc_context.burst_size;
+    // clock_frequency is the MIPI frame rate
+    stats->bandwidth = frame_bytes * lcdc_context.timing.clock_frequency;
+    stats->congested = lcdc_mipi_is_congested();
+}
+
+bool lcdc_mipi_is_congested(void) {
+    return lcdc_context.congested_frames != 0;
+}
@@ -21,6 +21,20 @@
 
 #define LOG_TAG "LcdcRgb"
 
+// raise the DMA burst one step of lcdc_burst_sizes per underflowing frame.
+#ifndef LCDC_DMA_AUTO_TUNE
+#define LCDC_DMA_AUTO_TUNE 1
+#endif
+
+// index into lcdc_burst_sizes the LCDC starts with
+#define LCDC_DMA_BURST_DEFAULT 0
+// frames the bus stays reported congested after an underflow
+#define LCDC_CONGESTION_FRAMES 30
+// lowest rate set_refresh_rate accepts, a stretched front porch much beyond this makes panels flicker
+#define LCDC_REFRESH_RATE_MIN 20
+// re-times the panel right after frame done, it has to get in before the blanking ends
+#define LCDC_RATE_TASK_PRIO 6
+
 typedef struct {
     // panel device
     panel_dev_t *panel;
@@ -35,10 +49,33 @@ typedef struct {
     display_driver_callback_t *callback;
     void *user_data;
 
+    // scan line waits, the line interrupt is only unmasked while one is pending
+    uint32_t line_target;
+    rtos_sema_t line_sema;
+    volatile bool line_waiting;
+
+    // telemetry, updated from the irq
+    volatile uint32_t frame_count;
+    volatile uint32_t underflow_count;
+    volatile uint32_t burst_size;
+    uint32_t burst_index;
+    volatile uint32_t congested_frames;
+    volatile bool underflow_pending;
+
+    // refresh rate switching, frame done wakes rate_task to apply it
+    LCDC_RGBInitTypeDef rgb_init;
+    rtos_sema_t rate_sema;
+    uint8_t *front_buffer;
+    volatile uint32_t refresh_rate;
+    volatile uint32_t pending_rate;
+
 } lcdc_context_t;
 
 static lcdc_context_t lcdc_context = {0};
 
+// burst sizes LCDC_DMABurstSizeConfig takes, smallest first
+static const uint32_t lcdc_burst_sizes[] = {2, 3, 4};
+
 static struct {
     uint32_t irq_num;
     uint32_t irq_priority;
@@ -52,6 +89,64 @@ static void lcdc_enable_clk(void) {
     LCDC_RccEnable();
 }
 
+// called at frame done, applies the auto tune policy to the underflows of the last frame.
+static void lcdc_update_burst(void) {
+    if (!lcdc_context.underflow_pending) {
+        if (lcdc_context.congested_frames) {
+            lcdc_context.congested_frames--;
+        }
+        return;
+    }
+    lcdc_context.underflow_pending = false;
+
+#if LCDC_DMA_AUTO_TUNE
+    if (lcdc_context.burst_index + 1 < sizeof(lcdc_burst_sizes) / sizeof(lcdc_burst_sizes[0])) {
+        lcdc_context.burst_index++;
+        lcdc_context.burst_size = lcdc_burst_sizes[lcdc_context.burst_index];
+        LCDC_DMABurstSizeConfig(LCDC, lcdc_context.burst_size);
+        RTK_LOGS(LOG_TAG, RTK_LOG_WARN, "underflow, dma burst raised to %d\n", lcdc_context.burst_size);
+        return;
+    }
+#endif
+
+    lcdc_context.congested_frames = LCDC_CONGESTION_FRAMES;
+}
+
+// re-time the panel in the blanking after frame done. The front porch grows with the
+// period so DCLK and the line timing the panel sees stay the same. A full LCDC_RGBInit,
+// too slow for the irq.
+static void lcdc_apply_refresh_rate(void) {
+    uint32_t rate = lcdc_context.pending_rate;
+    uint32_t base = lcdc_context.timing.clock_frequency;
+    uint32_t sync_lines = lcdc_context.timing.vsync_pulse_width + lcdc_context.timing.vsync_back_porch +
+                          lcdc_context.timing.height;
+    uint32_t vtotal = sync_lines + lcdc_context.timing.vsync_front_porch;
+
+    lcdc_context.pending_rate = 0;
+    if (rate == lcdc_context.refresh_rate) {
+        return;
+    }
+
+    lcdc_context.rgb_init.Panel_RgbTiming.RgbVfp = vtotal * base / rate - sync_lines;
+    lcdc_context.rgb_init.Panel_Init.RGBRefreshFreq = rate;
+
+    LCDC_Cmd(LCDC, DISABLE);
+    LCDC_RGBInit(LCDC, &lcdc_context.rgb_init);
+    LCDC_DMABurstSizeConfig(LCDC, lcdc_context.burst_size);
+    LCDC_INTConfig(LCDC, LCDC_BIT_LCD_FRD_INTEN | LCDC_BIT_DMA_UN_INTEN, ENABLE);
+    // a scan line wait keeps its target across the re-init
+    if (lcdc_context.line_waiting) {
+        LCDC_LineINTPosConfig(LCDC, lcdc_context.line_target);
+        LCDC_ClearINT(LCDC, LCDC_BIT_LCD_LIN_INTS);
+        LCDC_INTConfig(LCDC, LCDC_BIT_LCD_LIN_INTEN, ENABLE);
+    }
+    LCDC_DMAImgCfg(LCDC, (uint32_t)lcdc_context.front_buffer);
+    LCDC_ShadowReloadConfig(LCDC);
+    LCDC_Cmd(LCDC, ENABLE);
+
+    lcdc_context.refresh_rate = rate;
+}
+
 static void lcdc_irq_handler(void) {
     volatile uint32_t int_status = LCDC_GetINTStatus(LCDC);
     LCDC_ClearINT(LCDC, int_status);
@@ -60,93 +155,120 @@ static void lcdc_irq_handler(void) {
 
     if (int_status & LCDC_BIT_LCD_FRD_INTS) {
         RTK_LOGS(LOG_TAG, RTK_LOG_DEBUG, "irq: frame done\n");
+        lcdc_context.frame_count++;
+        lcdc_update_burst();
+
+        if (lcdc_context.pending_rate) {
+            rtos_sema_give(lcdc_context.rate_sema);
+        }
+
+        // the scan-out has left the old buffer, a flip from this frame has latched
+        if (lcdc_context.callback) {
+            lcdc_context.callback->vblank_handler(lcdc_context.user_data);
+        }
     }
 
     if (int_status & LCDC_BIT_LCD_LIN_INTS) {
         RTK_LOGS(LOG_TAG, RTK_LOG_DEBUG, "irq: line hit\n");
 
-        if (lcdc_context.callback) {
-            lcdc_context.callback->vblank_handler(lcdc_context.user_data);
+        LCDC_INTConfig(LCDC, LCDC_BIT_LCD_LIN_INTEN, DISABLE);
+        if (lcdc_context.line_waiting) {
+            lcdc_context.line_waiting = false;
+            rtos_sema_give(lcdc_context.line_sema);
         }
     }
 
     if (int_status & LCDC_BIT_DMA_UN_INTS) {
         RTK_LOGS(LOG_TAG, RTK_LOG_ERROR, "irq: dma underflow\n");
+        lcdc_context.underflow_count++;
+        lcdc_context.underflow_pending = true;
     }
 }
 
-static void lcdc_init_irq(lcd_timing_t *timing) {
+static void lcdc_rate_task(void *param) {
+    (void) param;
+
+    for (;;) {
+        rtos_sema_take(lcdc_context.rate_sema, RTOS_MAX_TIMEOUT);
+        if (lcdc_context.pending_rate) {
+            lcdc_apply_refresh_rate();
+        }
+    }
+}
+
+static void lcdc_init_irq(void) {
     // register interrupt
     InterruptRegister((IRQ_FUN)lcdc_irq_handler, lcdc_irq_info.irq_num,
                       (uint32_t)LCDC, lcdc_irq_info.irq_priority);
     InterruptEn(lcdc_irq_info.irq_num, lcdc_irq_info.irq_priority);
 
-    // enable interrupt
-    int line_intr_position = timing->height * 5 / 6;  // line interrupt position
-    LCDC_LineINTPosConfig(LCDC, line_intr_position);
-    LCDC_INTConfig(LCDC, LCDC_BIT_LCD_FRD_INTEN | LCDC_BIT_DMA_UN_INTEN |
-                   LCDC_BIT_LCD_LIN_INTEN, ENABLE);
+    // enable interrupt, the line interrupt is armed by scan line waits only
+    rtos_sema_create(&lcdc_context.line_sema, 0, 1);
+    LCDC_INTConfig(LCDC, LCDC_BIT_LCD_FRD_INTEN | LCDC_BIT_DMA_UN_INTEN, ENABLE);
 }
 
 static bool rgb_controller_init(const panel_timing_t *panel_timing) {
-    LCDC_RGBInitTypeDef rgb_init;
+    LCDC_RGBInitTypeDef *rgb_init = &lcdc_context.rgb_init;
 
     LCDC_Cmd(LCDC, DISABLE);
-    LCDC_RGBStructInit(&rgb_init);
+    LCDC_RGBStructInit(rgb_init);
 
     // panel timing
-    rgb_init.Panel_RgbTiming.RgbVsw = panel_timing->vsync_pulse_width;
-    rgb_init.Panel_RgbTiming.RgbVbp = panel_timing->vsync_back_porch;
-    rgb_init.Panel_RgbTiming.RgbVfp = panel_timing->vsync_front_porch;
-    rgb_init.Panel_RgbTiming.RgbHsw = panel_timing->hsync_pulse_width;
-    rgb_init.Panel_RgbTiming.RgbHbp = panel_timing->hsync_back_porch;
-    rgb_init.Panel_RgbTiming.RgbHfp = panel_timing->hsync_front_porch;
+    rgb_init->Panel_RgbTiming.RgbVsw = panel_timing->vsync_pulse_width;
+    rgb_init->Panel_RgbTiming.RgbVbp = panel_timing->vsync_back_porch;
+    rgb_init->Panel_RgbTiming.RgbVfp = panel_timing->vsync_front_porch;
+    rgb_init->Panel_RgbTiming.RgbHsw = panel_timing->hsync_pulse_width;
+    rgb_init->Panel_RgbTiming.RgbHbp = panel_timing->hsync_back_porch;
+    rgb_init->Panel_RgbTiming.RgbHfp = panel_timing->hsync_front_porch;
 
     // display param
-    rgb_init.Panel_Init.IfWidth = LCDC_RGB_IF_24_BIT;
-    rgb_init.Panel_Init.ImgWidth = panel_timing->width;
-    rgb_init.Panel_Init.ImgHeight = panel_timing->height;
+    rgb_init->Panel_Init.IfWidth = LCDC_RGB_IF_24_BIT;
+    rgb_init->Panel_Init.ImgWidth = panel_timing->width;
+    rgb_init->Panel_Init.ImgHeight = panel_timing->height;
 
     // polar settings
-    rgb_init.Panel_RgbTiming.Flags.RgbEnPolar = panel_timing->de_active_high ?
+    rgb_init->Panel_RgbTiming.Flags.RgbEnPolar = panel_timing->de_active_high ?
                                                 LCDC_RGB_EN_PUL_HIGH_LEV_ACTIVE : LCDC_RGB_EN_PUL_LOW_LEV_ACTIVE;
-    rgb_init.Panel_RgbTiming.Flags.RgbDclkActvEdge = panel_timing->dclk_falling_edge ?
+    rgb_init->Panel_RgbTiming.Flags.RgbDclkActvEdge = panel_timing->dclk_falling_edge ?
                                                 LCDC_RGB_DCLK_FALLING_EDGE_FETCH : LCDC_RGB_DCLK_RISING_EDGE_FETCH;
-    rgb_init.Panel_RgbTiming.Flags.RgbHsPolar = panel_timing->hsync_active_low ?
+    rgb_init->Panel_RgbTiming.Flags.RgbHsPolar = panel_timing->hsync_active_low ?
                                                 LCDC_RGB_HS_PUL_LOW_LEV_SYNC : LCDC_RGB_HS_PUL_HIGH_LEV_SYNC;
-    rgb_init.Panel_RgbTiming.Flags.RgbVsPolar = panel_timing->vsync_active_low ?
+    rgb_init->Panel_RgbTiming.Flags.RgbVsPolar = panel_timing->vsync_active_low ?
                                                 LCDC_RGB_VS_PUL_LOW_LEV_SYNC : LCDC_RGB_VS_PUL_HIGH_LEV_SYNC;
 
     // color formats
     switch (lcdc_context.in_format) {
         case LCD_FORMAT_RGB565:
-            rgb_init.Panel_Init.InputFormat = LCDC_INPUT_FORMAT_RGB565;
+            rgb_init->Panel_Init.InputFormat = LCDC_INPUT_FORMAT_RGB565;
             break;
         case LCD_FORMAT_ARGB8888:
-            rgb_init.Panel_Init.InputFormat = LCDC_INPUT_FORMAT_ARGB8888;
+            rgb_init->Panel_Init.InputFormat = LCDC_INPUT_FORMAT_ARGB8888;
             break;
         case LCD_FORMAT_RGB888:
         default:
-            rgb_init.Panel_Init.InputFormat = LCDC_INPUT_FORMAT_RGB888;
+            rgb_init->Panel_Init.InputFormat = LCDC_INPUT_FORMAT_RGB888;
             break;
     }
 
     switch (lcdc_context.out_format) {
         case LCD_FORMAT_RGB565:
-            rgb_init.Panel_Init.OutputFormat = LCDC_OUTPUT_FORMAT_RGB565;
-            rgb_init.Panel_Init.IfWidth = LCDC_RGB_IF_16_BIT;
+            rgb_init->Panel_Init.OutputFormat = LCDC_OUTPUT_FORMAT_RGB565;
+            rgb_init->Panel_Init.IfWidth = LCDC_RGB_IF_16_BIT;
             break;
         case LCD_FORMAT_RGB888:
         default:
-            rgb_init.Panel_Init.OutputFormat = LCDC_OUTPUT_FORMAT_RGB888;
-            rgb_init.Panel_Init.IfWidth = LCDC_RGB_IF_24_BIT;
+            rgb_init->Panel_Init.OutputFormat = LCDC_OUTPUT_FORMAT_RGB888;
+            rgb_init->Panel_Init.IfWidth = LCDC_RGB_IF_24_BIT;
             break;
     }
 
-    rgb_init.Panel_Init.RGBRefreshFreq = panel_timing->clock_frequency;
+    rgb_init->Panel_Init.RGBRefreshFreq = panel_timing->clock_frequency;
+    lcdc_context.refresh_rate = panel_timing->clock_frequency;
 
-    LCDC_RGBInit(LCDC, &rgb_init);
-    LCDC_DMABurstSizeConfig(LCDC, 2);
+    LCDC_RGBInit(LCDC, rgb_init);
+    lcdc_context.burst_index = LCDC_DMA_BURST_DEFAULT;
+    lcdc_context.burst_size = lcdc_burst_sizes[lcdc_context.burst_index];
+    LCDC_DMABurstSizeConfig(LCDC, lcdc_context.burst_size);
 
     RTK_LOGS(LOG_TAG, RTK_LOG_INFO, "lcdc_rgb_controller_init init done\n");
 
@@ -208,7 +330,13 @@ bool lcdc_rgb_controller_init(int32_t color_depth, panel_dev_t *panel) {
         return false;
     }
 
-    lcdc_init_irq(&lcdc_context.timing);
+    if (rtos_sema_create(&lcdc_context.rate_sema, 0, 1) != RTK_SUCCESS ||
+        rtos_task_create(NULL, "lcdc_rate", lcdc_rate_task, NULL, 1024 * 2, LCDC_RATE_TASK_PRIO) != RTK_SUCCESS) {
+        RTK_LOGS(LOG_TAG, RTK_LOG_ERROR, "failed to create refresh rate task\n");
+        return false;
+    }
+
+    lcdc_init_irq();
     lcdc_context.initialized = true;
 
     RTK_LOGS(LOG_TAG, RTK_LOG_INFO, "LCDC initialized with panel: %s\n",
@@ -224,6 +352,7 @@ void lcdc_rgb_do_page_flip(uint8_t *buffer) {
     }
 
     DCache_CleanInvalidate(0xFFFFFFFF, 0xFFFFFFFF);
+    lcdc_context.front_buffer = buffer;
     LCDC_DMAImgCfg(LCDC, (uint32_t)buffer);
     LCDC_ShadowReloadConfig(LCDC);
 
@@ -237,4 +366,76 @@ void lcdc_rgb_do_page_flip(uint8_t *buffer) {
 
 void lcdc_rgb_register_vblank_callback(display_driver_callback_t *event) {
     lcdc_context.callback = event;
-}
\ No newline at end of file
+}
+
+bool lcdc_rgb_wait_scanline(uint32_t line, uint32_t timeout_ms) {
+    if (!lcdc_context.lcdc_enabled || !lcdc_context.line_sema || line >= lcdc_context.timing.height) {
+        return false;
+    }
+
+    // move the line interrupt with it masked, a hit at the old position must not end the wait.
+    // The target is published first, a refresh rate switch in between puts it back itself.
+    LCDC_INTConfig(LCDC, LCDC_BIT_LCD_LIN_INTEN, DISABLE);
+    rtos_sema_take(lcdc_context.line_sema, 0);
+    lcdc_context.line_target = line;
+    lcdc_context.line_waiting = true;
+    LCDC_LineINTPosConfig(LCDC, line);
+    LCDC_ClearINT(LCDC, LCDC_BIT_LCD_LIN_INTS);
+    LCDC_INTConfig(LCDC, LCDC_BIT_LCD_LIN_INTEN, ENABLE);
+
+    if (rtos_sema_take(lcdc_context.line_sema, timeout_ms) != RTK_SUCCESS) {
+        LCDC_INTConfig(LCDC, LCDC_BIT_LCD_LIN_INTEN, DISABLE);
+        lcdc_context.line_waiting = false;
+        return false;
+    }
+
+    return true;
+}
+
+void lcdc_rgb_get_stats(display_stats_t *stats) {
+    uint32_t bytes_per_pixel;
+
+    switch (lcdc_context.in_format) {
+        case LCD_FORMAT_RGB565:
+            bytes_per_pixel = 2;
+            break;
+        case LCD_FORMAT_ARGB8888:
+            bytes_per_pixel = 4;
+            break;
+        case LCD_FORMAT_RGB888:
+        default:
+            bytes_per_pixel = 3;
+            break;
+    }
+
+    stats->frames = lcdc_context.frame_count;
+    stats->underflows = lcdc_context.underflow_count;
+    stats->burst_size = lcdc_context.burst_size;
+    stats->bandwidth = lcdc_context.timing.width * lcdc_context.timing.height *
+                       bytes_per_pixel * lcdc_context.refresh_rate;
+    stats->congested = lcdc_rgb_is_congested();
+}
+
+bool lcdc_rgb_is_congested(void) {
+    return lcdc_context.congested_frames != 0;
+}
+
+bool lcdc_rgb_set_refresh_rate(uint32_t rate) {
+    if (!lcdc_context.initialized || !lcdc_context.lcdc_enabled) {
+        return false;
+    }
+
+    // only slower than the panel timing, DCLK is never raised
+    if (rate < LCDC_REFRESH_RATE_MIN || rate > lcdc_context.timing.clock_frequency) {
+        RTK_LOGS(LOG_TAG, RTK_LOG_ERROR, "refresh rate %d out of range\n", rate);
+        return false;
+    }
+
+    lcdc_context.pending_rate = rate;
+
+    return true;
+}
+
+uint32_t lcdc_rgb_get_refresh_rate(void) {
+    return lcdc_context.refresh_rate;
+}
@@ -15,30 +15,276 @@
 
 #include "os_wrapper.h"
 #include "ameba_soc.h"
+#include "spi_api.h"
+#include "spi_ex_api.h"
 
 #include "panel_manager.h"
 #include "spi_only.h"
 
 #define LOG_TAG "ControllerSpiOnly"
 
-bool spi_only_controller_init(int32_t color_depth, panel_dev_t *panel) {
-    (void) color_depth;
+#define SPI_ONLY_CMD_CASET      0x2A
+#define SPI_ONLY_CMD_RASET      0x2B
+#define SPI_ONLY_CMD_RAMWR      0x2C
+
+#define SPI_ONLY_PIN_NONE       0xFFFFFFFF
+
+typedef struct {
+    // panel device
+    panel_dev_t *panel;
+    spi_t spi;
+    uint32_t dc_pin;
+
+    uint16_t width;
+    uint16_t height;
+    uint8_t bytes_per_pixel;
+    bool initialized;
+
+    // area being streamed, the cursor is the next source pixel to convert
+    const uint8_t *src;
+    uint16_t area_x1;
+    uint16_t area_x2;
+    uint16_t area_y2;
+    uint16_t cur_x;
+    uint16_t cur_y;
+
+    // tx done gives line_sema, or done_sema and the vblank callback after the last chunk
+    rtos_sema_t line_sema;
+    rtos_sema_t done_sema;
+    volatile bool last_chunk;
+
+    display_driver_callback_t *callback;
+    void *user_data;
+} spi_only_context_t;
+
+static spi_only_context_t spi_only_context = {0};
+
+// filled by the cpu while the other one is on the bus
+static uint8_t spi_only_line_buf[2][SPI_ONLY_LINE_BUF_SIZE] __attribute__((aligned(32)));
+
+// tx done fires once the DMA has filled the fifo, the last bytes of the
+// previous area may still be shifting out while their DC level matters.
+static void spi_only_wait_idle(void) {
+    while (spi_busy(&spi_only_context.spi)) {
+    }
+}
+
+static void spi_only_write_cmd(uint8_t cmd) {
+    spi_only_wait_idle();
+    GPIO_WriteBit(spi_only_context.dc_pin, 0);
+    spi_master_write(&spi_only_context.spi, cmd);
+    GPIO_WriteBit(spi_only_context.dc_pin, 1);
+}
+
+static void spi_only_write_data(uint8_t data) {
+    spi_master_write(&spi_only_context.spi, data);
+}
+
+static void spi_only_set_window(uint16_t x1, uint16_t y1, uint16_t x2, uint16_t y2) {
+    spi_only_write_cmd(SPI_ONLY_CMD_CASET);
+    spi_only_write_data(x1 >> 8);
+    spi_only_write_data(x1 & 0xFF);
+    spi_only_write_data(x2 >> 8);
+    spi_only_write_data(x2 & 0xFF);
+
+    spi_only_write_cmd(SPI_ONLY_CMD_RASET);
+    spi_only_write_data(y1 >> 8);
+    spi_only_write_data(y1 & 0xFF);
+    spi_only_write_data(y2 >> 8);
+    spi_only_write_data(y2 & 0xFF);
+
+    spi_only_write_cmd(SPI_ONLY_CMD_RAMWR);
+}
+
+static void spi_only_tx_done(uint32_t id, SpiIrq event) {
+    (void) id;
+
+    if (event != SpiTxIrq) {
+        return;
+    }
+
+    if (!spi_only_context.last_chunk) {
+        rtos_sema_give(spi_only_context.line_sema);
+        return;
+    }
+
+    rtos_sema_give(spi_only_context.done_sema);
+
+    if (spi_only_context.callback) {
+        spi_only_context.callback->vblank_handler(spi_only_context.user_data);
+    }
+}
+
+// the panel takes big-endian RGB565, LVGL renders little-endian.
+static inline void spi_only_convert_rgb565(uint16_t *dst, const uint16_t *src, uint32_t count) {
+    for (uint32_t i = 0; i < count; i++) {
+        uint16_t c = src[i];
+        dst[i] = (c << 8) | (c >> 8);
+    }
+}
+
+static inline void spi_only_convert_xrgb8888(uint16_t *dst, const uint32_t *src, uint32_t count) {
+    for (uint32_t i = 0; i < count; i++) {
+        uint32_t c = src[i];
+        uint16_t p = ((c >> 8) & 0xF800) | ((c >> 5) & 0x07E0) | ((c >> 3) & 0x001F);
+        dst[i] = (p << 8) | (p >> 8);
+    }
+}
+
+// convert the next pixels of the area into buf, returns the bytes written.
+static uint32_t spi_only_fill(uint8_t *buf) {
+    spi_only_context_t *ctx = &spi_only_context;
+    uint32_t stride = ctx->width * ctx->bytes_per_pixel;
+    uint32_t room = SPI_ONLY_LINE_BUF_SIZE / SPI_ONLY_BUS_BYTES_PER_PIXEL;
+    uint32_t done = 0;
+
+    while (room && ctx->cur_y <= ctx->area_y2) {
+        uint32_t count = MIN((uint32_t)(ctx->area_x2 - ctx->cur_x + 1), room);
+        const uint8_t *src = ctx->src + ctx->cur_y * stride + ctx->cur_x * ctx->bytes_per_pixel;
+        uint16_t *dst = (uint16_t *)buf + done;
+
+        if (ctx->bytes_per_pixel == 4) {
+            spi_only_convert_xrgb8888(dst, (const uint32_t *)src, count);
+        } else {
+            spi_only_convert_rgb565(dst, (const uint16_t *)src, count);
+        }
+
+        done += count;
+        room -= count;
+        ctx->cur_x += count;
+        if (ctx->cur_x > ctx->area_x2) {
+            ctx->cur_x = ctx->area_x1;
+            ctx->cur_y++;
+        }
+    }
+
+    return done * SPI_ONLY_BUS_BYTES_PER_PIXEL;
+}
 
+static void spi_only_send(uint8_t *buf, uint32_t len) {
+    DCache_Clean((uint32_t)buf, len);
+    spi_master_write_stream_dma(&spi_only_context.spi, (char *)buf, len);
+}
+
+bool spi_only_controller_init(int32_t color_depth, panel_dev_t *panel) {
     if (!panel || !panel->desc) {
         RTK_LOGS(LOG_TAG, RTK_LOG_ERROR, "Invalid panel device\n");
         return false;
     }
 
-    RTK_LOGS(LOG_TAG, RTK_LOG_ERROR, "unsupported panel: %s\n",
+    if (spi_only_context.initialized) {
+        RTK_LOGS(LOG_TAG, RTK_LOG_WARN, "spi controller already initialized\n");
+        return true;
+    }
+
+    panel_spi_config_t *spi_config = panel->desc->spi_config;
+    panel_gpio_config_t *gpio_config = panel->desc->gpio_config;
+
+    if (!spi_config || !spi_config->status) {
+        RTK_LOGS(LOG_TAG, RTK_LOG_ERROR, "no spi config for panel: %s\n",
+                 panel->desc->name);
+        return false;
+    }
+
+    // pixels go out as plain 8-bit DMA streams, which needs a 4-wire bus.
+    if (!gpio_config || gpio_config->dc_pin == SPI_ONLY_PIN_NONE) {
+        RTK_LOGS(LOG_TAG, RTK_LOG_ERROR, "no dc pin for panel: %s\n",
+                 panel->desc->name);
+        return false;
+    }
+
+    if (color_depth != 16 && color_depth != 32) {
+        RTK_LOGS(LOG_TAG, RTK_LOG_ERROR, "unsupported color depth: %d\n", color_depth);
+        return false;
+    }
+
+    spi_only_context.panel = panel;
+    spi_only_context.width = panel->desc->timing.width;
+    spi_only_context.height = panel->desc->timing.height;
+    spi_only_context.bytes_per_pixel = color_depth / 8;
+    spi_only_context.dc_pin = gpio_config->dc_pin;
+
+    GPIO_InitTypeDef dc;
+    dc.GPIO_Pin = spi_only_context.dc_pin;
+    dc.GPIO_PuPd = GPIO_PuPd_NOPULL;
+    dc.GPIO_Mode = GPIO_Mode_OUT;
+    GPIO_Init(&dc);
+    GPIO_WriteBit(spi_only_context.dc_pin, 1);
+
+    spi_only_context.spi.spi_idx = spi_config->spi_index == 0 ? MBED_SPI0 : MBED_SPI1;
+    spi_init(&spi_only_context.spi, spi_config->mosi_pin, spi_config->miso_pin,
+             spi_config->sclk_pin, spi_config->cs_pin);
+    spi_format(&spi_only_context.spi, 8, 3, 0);
+    spi_frequency(&spi_only_context.spi, SPI_ONLY_BUS_FREQUENCY);
+    spi_irq_hook(&spi_only_context.spi, (spi_irq_handler) spi_only_tx_done,
+                 (uint32_t)&spi_only_context);
+
+    if (rtos_sema_create(&spi_only_context.line_sema, 0, 1) != RTK_SUCCESS) {
+        RTK_LOGS(LOG_TAG, RTK_LOG_ERROR, "failed to create line semaphore\n");
+        return false;
+    }
+
+    // available while the bus is idle, taken for a whole area
+    if (rtos_sema_create(&spi_only_context.done_sema, 1, 1) != RTK_SUCCESS) {
+        RTK_LOGS(LOG_TAG, RTK_LOG_ERROR, "failed to create done semaphore\n");
+        return false;
+    }
+
+    spi_only_context.initialized = true;
+
+    RTK_LOGS(LOG_TAG, RTK_LOG_INFO, "spi controller initialized with panel: %s\n",
              panel->desc->name);
 
     return true;
 }
 
+bool spi_only_flush_area(uint8_t *buffer, uint16_t x1, uint16_t y1, uint16_t x2, uint16_t y2) {
+    if (!spi_only_context.initialized) {
+        RTK_LOGS(LOG_TAG, RTK_LOG_INFO, "spi controller not initialized\n");
+        return false;
+    }
+
+    if (x1 > x2 || y1 > y2 || x2 >= spi_only_context.width || y2 >= spi_only_context.height) {
+        RTK_LOGS(LOG_TAG, RTK_LOG_ERROR, "invalid area (%d,%d)-(%d,%d)\n", x1, y1, x2, y2);
+        return false;
+    }
+
+    // e.g. the splash from display_mode_init may still be on the bus
+    rtos_sema_take(spi_only_context.done_sema, RTOS_MAX_TIMEOUT);
+
+    spi_only_context.src = buffer;
+    spi_only_context.area_x1 = x1;
+    spi_only_context.area_x2 = x2;
+    spi_only_context.area_y2 = y2;
+    spi_only_context.cur_x = x1;
+    spi_only_context.cur_y = y1;
+    spi_only_context.last_chunk = false;
+
+    spi_only_set_window(x1, y1, x2, y2);
+
+    // the panel keeps its RAMWR address between transfers, so the chunks
+    // just follow each other. Each one is converted while the previous
+    // one is on the bus.
+    uint8_t index = 0;
+    uint32_t len = spi_only_fill(spi_only_line_buf[index]);
+    spi_only_context.last_chunk = spi_only_context.cur_y > y2;
+    spi_only_send(spi_only_line_buf[index], len);
+
+    while (!spi_only_context.last_chunk) {
+        index ^= 1;
+        len = spi_only_fill(spi_only_line_buf[index]);
+        rtos_sema_take(spi_only_context.line_sema, RTOS_MAX_TIMEOUT);
+        spi_only_context.last_chunk = spi_only_context.cur_y > y2;
+        spi_only_send(spi_only_line_buf[index], len);
+    }
+
+    return true;
+}
+
 void spi_only_do_page_flip(uint8_t *buffer) {
-    (void) buffer;
+    spi_only_flush_area(buffer, 0, 0, spi_only_context.width - 1, spi_only_context.height - 1);
 }
 
 void spi_only_register_vblank_callback(display_driver_callback_t *event) {
-    (void) event;
-}
\ No newline at end of file
+    spi_only_context.callback = event;
+}
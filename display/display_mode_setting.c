@@ -51,10 +51,24 @@
 #define SELECTED_PANEL_NAME "unknown"
 #endif
 
+#define DISPLAY_INIT_TASK_STACK_SIZE    (4 * 1024)
+#define DISPLAY_INIT_TASK_PRIORITY      1
+
+// a frame at the lowest refresh rate (20 Hz) with some slack
+#define DISPLAY_SCANLINE_TIMEOUT_MS     60
+
 typedef struct {
     panel_dev_t *panel;
     display_mode_callback_t *callback;
     display_driver_callback_t lcdc_callback;
+
+    // background bring-up
+    rtos_sema_t ready_sema;
+    int32_t color_depth;
+    bool init_ok;
+
+    // frame in flash shown from panel power-on until the first flip
+    const uint8_t *splash;
 } display_mode_t;
 
 static display_mode_t display_mode = {0};
@@ -70,10 +84,59 @@ void display_mode_set_callback(display_mode_callback_t *callback) {
     display_mode.callback = callback;
 }
 
+void display_mode_set_splash(const uint8_t *image) {
+    display_mode.splash = image;
+}
+
+const uint8_t *display_mode_get_splash(void) {
+    return display_mode.splash;
+}
+
 void display_mode_flip_buffer(uint8_t *buffer) {
     controller_do_page_flip(buffer);
 }
 
+bool display_mode_flush_area(uint8_t *buffer, uint16_t x1, uint16_t y1, uint16_t x2, uint16_t y2) {
+    return controller_flush_area(buffer, x1, y1, x2, y2);
+}
+
+bool display_mode_flush_is_async(void) {
+    return controller_flush_is_async();
+}
+
+bool display_mode_is_partial(void) {
+    return display_mode.panel && (display_mode.panel->desc->interface == PANEL_IF_SPI ||
+                                  display_mode.panel->desc->command_mode);
+}
+
+bool display_mode_wait_scanline(uint32_t line) {
+    return controller_wait_scanline(line, DISPLAY_SCANLINE_TIMEOUT_MS);
+}
+
+void display_mode_get_stats(display_stats_t *stats) {
+    controller_get_stats(stats);
+}
+
+bool display_mode_is_congested(void) {
+    return controller_is_congested();
+}
+
+bool display_mode_set_refresh_rate(uint32_t rate) {
+    return controller_set_refresh_rate(rate);
+}
+
+uint32_t display_mode_get_refresh_rate(void) {
+    return controller_get_refresh_rate();
+}
+
+uint32_t display_mode_get_plane_count(void) {
+    return controller_get_plane_count();
+}
+
+bool display_mode_set_plane(uint32_t plane, const display_plane_t *config) {
+    return controller_set_plane(plane, config);
+}
+
 void fillPureBlueBuffer(uint32_t* buffer, int total_pixels) {
     uint32_t pureBlue = 0xFF0000FF; // ARGB: A=FF, R=00, G=00, B=FF
 
@@ -218,13 +281,19 @@ bool display_mode_init(int32_t color_depth) {
         return false;
     }
 
-    // 9. turn on back light.
+    // 9. scan out the splash straight from flash, the back light comes on with it.
+    if (display_mode.splash) {
+        controller_do_page_flip((uint8_t *)display_mode.splash);
+        RTK_LOGS(LOG_TAG, RTK_LOG_INFO, "splash shown\n");
+    }
+
+    // 10. turn on back light.
     panel_set_backlight(panel, 150);
 
-    // 10. enable display.
+    // 11. enable display.
     panel_enable_display(panel);
 
-    // 11. register vblank
+    // 12. register vblank
     display_mode.lcdc_callback.vblank_handler = display_vblank_handler;
     controller_register_vblank_callback(&display_mode.lcdc_callback);
 
@@ -239,3 +308,55 @@ bool display_mode_init(int32_t color_depth) {
 
     return true;
 }
+
+bool display_mode_init_sync(int32_t color_depth) {
+    display_mode.color_depth = color_depth;
+    display_mode.init_ok = display_mode_init(color_depth);
+
+    return display_mode.init_ok;
+}
+
+static void display_mode_init_task(void *param) {
+    (void) param;
+    uint32_t start = rtos_time_get_current_system_time_ms();
+
+    display_mode.init_ok = display_mode_init(display_mode.color_depth);
+
+    RTK_LOGS(LOG_TAG, RTK_LOG_INFO, "panel bring-up took %d ms\n",
+             rtos_time_get_current_system_time_ms() - start);
+
+    rtos_sema_give(display_mode.ready_sema);
+    rtos_task_delete(NULL);
+}
+
+bool display_mode_init_async(int32_t color_depth) {
+    display_mode.color_depth = color_depth;
+    display_mode.init_ok = false;
+
+    if (rtos_sema_create(&display_mode.ready_sema, 0, 1) != RTK_SUCCESS) {
+        RTK_LOGS(LOG_TAG, RTK_LOG_ERROR, "Failed to create ready semaphore\n");
+        return false;
+    }
+
+    if (rtos_task_create(NULL, "display_init", display_mode_init_task, NULL,
+                         DISPLAY_INIT_TASK_STACK_SIZE, DISPLAY_INIT_TASK_PRIORITY) != RTK_SUCCESS) {
+        RTK_LOGS(LOG_TAG, RTK_LOG_ERROR, "Failed to create display init task\n");
+        rtos_sema_delete(display_mode.ready_sema);
+        display_mode.ready_sema = NULL;
+        return false;
+    }
+
+    return true;
+}
+
+bool display_mode_wait_ready(void) {
+    if (!display_mode.ready_sema) {
+        return display_mode.init_ok;
+    }
+
+    rtos_sema_take(display_mode.ready_sema, RTOS_MAX_TIMEOUT);
+    rtos_sema_delete(display_mode.ready_sema);
+    display_mode.ready_sema = NULL;
+
+    return display_mode.init_ok;
+}
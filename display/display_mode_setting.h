@@ -19,14 +19,51 @@
 #include <stdint.h>
 #include <stdbool.h>
 
+#include "display_controller.h"
+
 typedef struct {
     void (*vblank_handler)(void);
 } display_mode_callback_t;
 
 bool display_mode_init(int32_t color_depth);
+// run display_mode_init on its own task, so panel reset and init tables overlap other boot work.
+bool display_mode_init_async(int32_t color_depth);
+// display_mode_init that keeps its result for display_mode_wait_ready, the fallback when
+// display_mode_init_async can't start its task.
+bool display_mode_init_sync(int32_t color_depth);
+// block until the display_mode_init_async bring-up is done, returns its result.
+bool display_mode_wait_ready(void);
 void display_mode_set_callback(display_mode_callback_t *callback);
 void display_mode_flip_buffer(uint8_t *buffer);
 
+// full frame in the panel size and color depth, e.g. in XIP flash, flipped right after panel
+// power-on until the first display_mode_flip_buffer. Set before display_mode_init.
+void display_mode_set_splash(const uint8_t *image);
+const uint8_t *display_mode_get_splash(void);
+
+// true when the panel keeps its own frame memory and takes dirty areas instead of whole frames.
+bool display_mode_is_partial(void);
+// send one area of a full size frame buffer. Completion is reported through the vblank callback
+// if display_mode_flush_is_async, otherwise the area is sent when it returns.
+bool display_mode_flush_area(uint8_t *buffer, uint16_t x1, uint16_t y1, uint16_t x2, uint16_t y2);
+bool display_mode_flush_is_async(void);
+
+// block until the LCDC scan-out reaches line, false if there is no line interrupt or it timed out.
+bool display_mode_wait_scanline(uint32_t line);
+
+// LCDC frame/underflow counters and bandwidth estimate, see display_stats_t.
+void display_mode_get_stats(display_stats_t *stats);
+// true while the scan-out keeps underflowing, bus masters like the PPE should back off.
+bool display_mode_is_congested(void);
+
+// scan-out rate switching, e.g. a lower rate while the UI is idle. false where the rate is fixed.
+bool display_mode_set_refresh_rate(uint32_t rate);
+uint32_t display_mode_get_refresh_rate(void);
+
+// extra hardware planes composed under/over the LVGL plane at scan-out, see display_plane_t.
+uint32_t display_mode_get_plane_count(void);
+bool display_mode_set_plane(uint32_t plane, const display_plane_t *config);
+
 static inline int32_t display_mode_get_width(void) {
 #if defined(CONFIG_ST7701S_MIPI) && CONFIG_ST7701S_MIPI
     return 480;
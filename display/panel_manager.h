@@ -57,6 +57,7 @@ typedef struct {
     uint32_t dc_pin;
     uint32_t bl_pin;
     uint32_t power_en_pin;
+    uint32_t te_pin;        // tearing effect output, used by command mode panels
 } panel_gpio_config_t;
 
 typedef struct {
@@ -66,6 +67,7 @@ typedef struct {
     uint32_t mosi_pin;
     uint32_t miso_pin;
     uint32_t sclk_pin;
+    uint32_t frequency;     // init clock in Hz, 0 for PANEL_SPI_INIT_DEFAULT_FREQUENCY
 } panel_spi_config_t;
 
 typedef struct {
@@ -111,6 +113,7 @@ typedef struct panel_descriptor {
 
     panel_interface_t interface;
     panel_rgb_format_t rgb_format;
+    bool command_mode;      // DSI panel with its own frame memory, updated by DCS writes
 
     panel_timing_t timing;
     panel_gpio_config_t *gpio_config;
@@ -30,7 +30,8 @@ pin_config_entry_t default_pin_configs[] = {
             .cs_pin = 0xFFFFFFFF,
             .dc_pin = 0xFFFFFFFF,
             .bl_pin = 0xFFFFFFFF,
-            .power_en_pin = 0xFFFFFFFF
+            .power_en_pin = 0xFFFFFFFF,
+            .te_pin = 0xFFFFFFFF
         },
         .spi_config = {
             .status = true,
@@ -85,7 +86,8 @@ pin_config_entry_t default_pin_configs[] = {
             .cs_pin = 0xFFFFFFFF,
             .dc_pin = 0xFFFFFFFF,
             .bl_pin = _PB_3,
-            .power_en_pin = _PA_17
+            .power_en_pin = _PA_17,
+            .te_pin = 0xFFFFFFFF
         },
         .spi_config = {
             .status = false,
@@ -135,7 +137,8 @@ pin_config_entry_t default_pin_configs[] = {
             .cs_pin = _PA_19,
             .dc_pin = 0xFFFFFFFF,
             .bl_pin = _PA_25,
-            .power_en_pin = 0xFFFFFFFF
+            .power_en_pin = 0xFFFFFFFF,
+            .te_pin = 0xFFFFFFFF
         },
         .spi_config = {
             .status = true,
@@ -190,7 +193,8 @@ pin_config_entry_t default_pin_configs[] = {
             .cs_pin = 0xFFFFFFFF,
             .dc_pin = 0xFFFFFFFF,
             .bl_pin = _PA_25,
-            .power_en_pin = _PA_23
+            .power_en_pin = _PA_23,
+            .te_pin = 0xFFFFFFFF
         },
         .spi_config = {
             .status = false,
@@ -240,7 +244,8 @@ pin_config_entry_t default_pin_configs[] = {
             .cs_pin = 0xFFFFFFFF,
             .dc_pin = 0xFFFFFFFF,
             .bl_pin = _PC_0,
-            .power_en_pin = 0xFFFFFFFF
+            .power_en_pin = 0xFFFFFFFF,
+            .te_pin = 0xFFFFFFFF
         },
         .spi_config = {
             .status = true,
@@ -248,7 +253,8 @@ pin_config_entry_t default_pin_configs[] = {
             .cs_pin = _PB_27,
             .sclk_pin = _PB_28,
             .mosi_pin = _PB_29,
-            .miso_pin = 0xFFFFFFFF
+            .miso_pin = 0xFFFFFFFF,
+            .frequency = 10000000    // ST7701 serial write cycle is 66 ns min
         },
         .rgb_data_config = {
             .status = true,
@@ -287,7 +293,8 @@ pin_config_entry_t default_pin_configs[] = {
             .cs_pin = 0xFFFFFFFF,
             .dc_pin = 0xFFFFFFFF,
             .bl_pin = _PA_25,
-            .power_en_pin = 0xFFFFFFFF
+            .power_en_pin = 0xFFFFFFFF,
+            .te_pin = 0xFFFFFFFF
         },
         .spi_config = {
             .status = true,
@@ -295,7 +302,8 @@ pin_config_entry_t default_pin_configs[] = {
             .cs_pin = _PA_20,
             .sclk_pin = _PA_21,
             .mosi_pin = _PA_22,
-            .miso_pin = 0xFFFFFFFF
+            .miso_pin = 0xFFFFFFFF,
+            .frequency = 10000000    // ST7701 serial write cycle is 66 ns min
         },
         .rgb_data_config = {
             .status = true,
@@ -342,7 +350,8 @@ pin_config_entry_t default_pin_configs[] = {
             .cs_pin = 0xFFFFFFFF,
             .dc_pin = 0xFFFFFFFF,
             .bl_pin = _PA_25,
-            .power_en_pin = 0xFFFFFFFF
+            .power_en_pin = 0xFFFFFFFF,
+            .te_pin = 0xFFFFFFFF
         },
         .spi_config = {
             .status = false,
@@ -392,7 +401,8 @@ pin_config_entry_t default_pin_configs[] = {
             .cs_pin = 0xFFFFFFFF,
             .dc_pin = 0xFFFFFFFF,
             .bl_pin = 0xFFFFFFFF,
-            .power_en_pin = 0xFFFFFFFF
+            .power_en_pin = 0xFFFFFFFF,
+            .te_pin = 0xFFFFFFFF
         },
         .spi_config = {
             .status = false,
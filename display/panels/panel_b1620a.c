@@ -45,6 +45,11 @@ static const panel_timing_t b1620a_timing = {
     .use_de = true
 };
 
+// packed by PANEL_INIT_CMD, sent in bursts by panel_spi_send_init_table.
+static const uint8_t b1620a_init_table[] = {
+    #include "panel_b1620a_spi.inc"
+};
+
 typedef struct {
     bool spi_initialized;
     spi_t spi_lcd;
@@ -60,7 +65,7 @@ static bool b1620a_init(void *panel_data) {
 
     spi_driver_init(spi, panel->desc->spi_config);
 
-    #include "panel_b1620a_spi.inc"
+    panel_spi_send_init_table(spi, b1620a_init_table, sizeof(b1620a_init_table));
 
     priv_data->spi_initialized = true;
 
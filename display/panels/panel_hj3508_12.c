@@ -46,6 +46,11 @@ static const panel_timing_t hj3508_12_timing = {
     .use_de = true
 };
 
+// packed by PANEL_INIT_CMD, sent in bursts by panel_spi_send_init_table.
+static const uint8_t hj3508_12_init_table[] = {
+    #include "panel_hj3508_12_spi.inc"
+};
+
 typedef struct {
     bool spi_initialized;
     spi_t spi_lcd;
@@ -61,7 +66,7 @@ static bool hj3508_12_init(void *panel_data) {
 
     spi_driver_init(spi, panel->desc->spi_config);
 
-    #include "panel_hj3508_12_spi.inc"
+    panel_spi_send_init_table(spi, hj3508_12_init_table, sizeof(hj3508_12_init_table));
 
     priv_data->spi_initialized = true;
 
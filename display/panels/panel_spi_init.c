@@ -16,11 +16,15 @@
 #include "os_wrapper.h"
 #include "ameba_soc.h"
 #include "spi_api.h"
+#include "spi_ex_api.h"
 
 #include "panel_spi_init.h"
 
 #define LOG_TAG "PanelSpiInit"
 
+static uint16_t init_burst[PANEL_SPI_INIT_BURST_WORDS] __attribute__((aligned(32)));
+static rtos_sema_t init_burst_sema = NULL;
+
 void spi_write_command(spi_t *spi, u16 cmd) {
     spi_master_write(spi, cmd);
 }
@@ -39,6 +43,73 @@ void spi_driver_init(spi_t *spi, panel_spi_config_t *spi_config) {
 
     spi_init(spi, spi_config->mosi_pin, spi_config->miso_pin,
                        spi_config->sclk_pin, spi_config->cs_pin);
-    spi_frequency(spi, 5000000);
+    spi_frequency(spi, spi_config->frequency ? spi_config->frequency : PANEL_SPI_INIT_DEFAULT_FREQUENCY);
     spi_format(spi, 9, 3, 0);
+}
+
+static void init_burst_done(uint32_t id, SpiIrq event) {
+    (void) id;
+
+    if (event == SpiTxIrq) {
+        rtos_sema_give(init_burst_sema);
+    }
+}
+
+static void init_burst_flush(spi_t *spi, uint32_t words) {
+    if (!words) {
+        return;
+    }
+
+    // 9-bit frames go out as halfwords.
+    DCache_Clean((uint32_t)init_burst, words * sizeof(uint16_t));
+    spi_master_write_stream_dma(spi, (char *)init_burst, words * sizeof(uint16_t));
+    rtos_sema_take(init_burst_sema, RTOS_MAX_TIMEOUT);
+}
+
+void panel_spi_send_init_table(spi_t *spi, const uint8_t *table, uint32_t size) {
+    uint32_t words = 0;
+    uint32_t pos = 0;
+    uint32_t start = rtos_time_get_current_system_time_ms();
+
+    if (!init_burst_sema && rtos_sema_create(&init_burst_sema, 0, 1) != RTK_SUCCESS) {
+        RTK_LOGS(LOG_TAG, RTK_LOG_ERROR, "failed to create burst semaphore\n");
+        return;
+    }
+
+    spi_irq_hook(spi, (spi_irq_handler) init_burst_done, (uint32_t)spi);
+
+    while (pos + 2 <= size) {
+        uint8_t cmd = table[pos];
+        uint8_t len = table[pos + 1];
+
+        if (len == PANEL_INIT_DELAY_MARK) {
+            init_burst_flush(spi, words);
+            words = 0;
+            rtos_time_delay_ms(table[pos + 2] | (table[pos + 3] << 8));
+            pos += 4;
+            continue;
+        }
+
+        if (pos + 2 + len > size) {
+            RTK_LOGS(LOG_TAG, RTK_LOG_ERROR, "truncated init table at %d\n", pos);
+            break;
+        }
+
+        // a command never straddles two bursts.
+        if (words + 1 + len > PANEL_SPI_INIT_BURST_WORDS) {
+            init_burst_flush(spi, words);
+            words = 0;
+        }
+
+        init_burst[words++] = cmd;
+        for (uint8_t i = 0; i < len; i++) {
+            init_burst[words++] = table[pos + 2 + i] | BIT8;
+        }
+        pos += 2 + len;
+    }
+
+    init_burst_flush(spi, words);
+
+    RTK_LOGS(LOG_TAG, RTK_LOG_INFO, "init table of %d bytes sent in %d ms\n", size,
+             rtos_time_get_current_system_time_ms() - start);
 }
\ No newline at end of file
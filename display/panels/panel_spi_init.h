@@ -23,9 +23,24 @@
 
 struct spi_t;
 
+// init tables are a byte stream of [cmd, param count, params...] entries,
+// a delay is [0x00, PANEL_INIT_DELAY_MARK, ms low, ms high].
+#define PANEL_INIT_DELAY_MARK           0xFF
+
+#define PANEL_INIT_CMD(cmd, ...)        (cmd), sizeof((const uint8_t[]){__VA_ARGS__}), __VA_ARGS__
+#define PANEL_INIT_CMD0(cmd)            (cmd), 0
+#define PANEL_INIT_DELAY(ms)            0x00, PANEL_INIT_DELAY_MARK, ((ms) & 0xFF), (((ms) >> 8) & 0xFF)
+
+// 9-bit words buffered per DMA burst.
+#define PANEL_SPI_INIT_BURST_WORDS      128
+
+// init clock for panels whose spi config doesn't give one.
+#define PANEL_SPI_INIT_DEFAULT_FREQUENCY 5000000
+
 void spi_write_command(spi_t *spi, u16 cmd);
 void spi_write_data(spi_t *spi,u16 data);
 
 void spi_driver_init(spi_t *spi, panel_spi_config_t *spi_config);
+void panel_spi_send_init_table(spi_t *spi, const uint8_t *table, uint32_t size);
 
 #endif // AMEBA_UI_DISPLAY_PANELS_PANEL_SPI_INIT_H
\ No newline at end of file
@@ -266,6 +266,7 @@ panel_desc_t st7701s_mipi_desc = {
 
     .interface = PANEL_IF_MIPI_DSI,
     .rgb_format = PANEL_RGB_FORMAT_RGB888,
+    .command_mode = false,  // video mode, command mode wants te_pin wired on the board
 
     .timing = st7701s_mipi_timing,
     .gpio_config = NULL,
@@ -45,6 +45,11 @@ static const panel_timing_t st7701s_rgb565_timing = {
     .use_de = true
 };
 
+// packed by PANEL_INIT_CMD, sent in bursts by panel_spi_send_init_table.
+static const uint8_t st7701s_rgb565_init_table[] = {
+    #include "panel_st7701s_rgb565_spi.inc"
+};
+
 typedef struct {
     bool spi_initialized;
     spi_t spi_lcd;
@@ -60,7 +65,7 @@ static bool st7701s_rgb565_init(void *panel_data) {
 
     spi_driver_init(spi, panel->desc->spi_config);
 
-    #include "panel_st7701s_rgb565_spi.inc"
+    panel_spi_send_init_table(spi, st7701s_rgb565_init_table, sizeof(st7701s_rgb565_init_table));
 
     priv_data->spi_initialized = true;
 
@@ -31,7 +31,8 @@ static panel_gpio_config_t st7789v_gpio_config = {
     .cs_pin = _PB_14,     // SPI CS
     .dc_pin = _PB_15,     // SPI DC
     .bl_pin = _PB_3,
-    .power_en_pin = _PA_17
+    .power_en_pin = _PA_17,
+    .te_pin = 0xFFFFFFFF
 };
 
 // ST7789V timing parameters（240x320）
@@ -20,7 +20,11 @@
 
 #define WIDTH            240
 #define HEIGHT           320
-#define PPE_MEM_SIZE     WIDTH * HEIGHT * 2        //rgb565
+#define BPP              2                         //rgb565
+#define STRIDE           (WIDTH * BPP)
+
+/* Sets up the next window of a flush, the PPE irq only hands it over */
+#define WINDOW_TASK_PRIO 3
 
 
 static QSPI_CmdAddrInfo info;
@@ -30,6 +34,13 @@ u32 ili9341_buf_len = 0;
 static ILI9341VBlankCallback *g_callback = NULL;
 static void *g_data = NULL;
 
+/* Windows of the flush in progress, the PPE irq wakes window_task for the next one */
+static rtos_sema_t g_window_sema = NULL;
+static ILI9341Rect g_rects[ILI9341_MAX_RECTS];
+static int g_rect_cnt = 0;
+static int g_rect_idx = 0;
+static u8 *g_buffer = NULL;
+
 static void LCD_SPI_WR_REG(u8 cmd)
 {
     info.cmd[0] = cmd;
@@ -166,22 +177,24 @@ static void ili9341_config_init(void)
     QSPI_Write(&info, ili9341_buf, ili9341_buf_len);
 }
 
-/* PPE use as a DMA */
-static void Prepare_PPE(uint8_t *buffer)
+/* PPE use as a DMA, reading the rectangle with the frame stride */
+static void Prepare_PPE(uint8_t *buffer, const ILI9341Rect *rect)
 {
-    DCache_CleanInvalidate((u32)buffer, PPE_MEM_SIZE);
+    u16 w = rect->x2 - rect->x1 + 1;
+    u16 h = rect->y2 - rect->y1 + 1;
+
     PPE_InputLayer_InitTypeDef PPE_Input_Layer1;
     PPE_InputLayer_StructInit(&PPE_Input_Layer1);
-    PPE_Input_Layer1.src_addr = (u32)buffer;
+    PPE_Input_Layer1.src_addr = (u32)(buffer + rect->y1 * STRIDE + rect->x1 * BPP);
     PPE_Input_Layer1.start_x = 0;
     PPE_Input_Layer1.start_y = 0;
-    PPE_Input_Layer1.width = WIDTH;
-    PPE_Input_Layer1.height = HEIGHT;
+    PPE_Input_Layer1.width = w;
+    PPE_Input_Layer1.height = h;
     PPE_Input_Layer1.const_ABGR8888_value = 0xFFFFFFFF;
     PPE_Input_Layer1.format = PPE_RGB565;
     PPE_Input_Layer1.src = PPE_LAYER_SRC_FROM_DMA;
     PPE_Input_Layer1.color_key_en = DISABLE;
-    PPE_Input_Layer1.line_len = PPE_Input_Layer1.width;
+    PPE_Input_Layer1.line_len = WIDTH;
     PPE_Input_Layer1.key_color_value = 0;
     PPE_InitInputLayer(1, &PPE_Input_Layer1);
 
@@ -189,10 +202,10 @@ static void Prepare_PPE(uint8_t *buffer)
     PPE_ResultLayer_InitTypeDef PPE_Result_Layer;
     PPE_ResultLayer_StructInit(&PPE_Result_Layer);
     PPE_Result_Layer.src_addr = (u32) & (QSPI->DR[0].BYTE);
-    PPE_Result_Layer.width = WIDTH;
-    PPE_Result_Layer.height = HEIGHT;
+    PPE_Result_Layer.width = w;
+    PPE_Result_Layer.height = h;
     PPE_Result_Layer.format = PPE_RGB565;
-    PPE_Result_Layer.line_len = PPE_Result_Layer.width;
+    PPE_Result_Layer.line_len = w;
     PPE_Result_Layer.type = PPE_ADDR_QSPI;
     PPE_InitResultLayer(&PPE_Result_Layer);
 
@@ -203,10 +216,66 @@ static void Prepare_PPE(uint8_t *buffer)
     PPE_Init(&PPE_Init_User);
 }
 
+/* The PPE is done once it has pushed the last pixels, the QSPI may still be sending them */
+static void LCD_WAIT_IDLE(void)
+{
+    while (QSPI->SR & BIT_BUSY) {
+    }
+}
+
+static void LCD_SET_WINDOW(u16 x0, u16 y0, u16 x1, u16 y1)
+{
+    u8 data[4];
+
+    LCD_WAIT_IDLE();
+
+    data[0] = x0 >> 8;
+    data[1] = x0 & 0xff;
+    data[2] = x1 >> 8;
+    data[3] = x1 & 0xff;
+    info.cmd[0] = 0x2A;
+    QSPI_Write(&info, data, 4);
+
+    data[0] = y0 >> 8;
+    data[1] = y0 & 0xff;
+    data[2] = y1 >> 8;
+    data[3] = y1 & 0xff;
+    info.cmd[0] = 0x2B;
+    QSPI_Write(&info, data, 4);
+}
+
+static void start_rect(const ILI9341Rect *rect)
+{
+    u32 size = (rect->x2 - rect->x1 + 1) * (rect->y2 - rect->y1 + 1) * BPP;
+
+    Prepare_PPE(g_buffer, rect);
+    LCD_SET_WINDOW(rect->x1, rect->y1, rect->x2, rect->y2);
+
+    info.cmd[0] = 0x2C;
+    QSPI_WriteStart(&info, size);
+    PPE_Cmd(ENABLE);
+}
+
+static void window_task(void *param)
+{
+    (void)param;
+
+    for (;;) {
+        rtos_sema_take(g_window_sema, RTOS_MAX_TIMEOUT);
+        start_rect(&g_rects[g_rect_idx]);
+    }
+}
+
 void *PPE_Handler(void)
 {
     if (PPE->INT_STATUS & BIT1) {
         PPE->INT_CLR |= BIT1;
+        /* Send the next merged window, report the flush after the last one */
+        if (++g_rect_idx < g_rect_cnt) {
+            /* QSPI_Write blocks until the window is set, not for irq context */
+            rtos_sema_give(g_window_sema);
+            return NULL;
+        }
         if (g_callback) {
             g_callback->VBlank(g_data);
         }
@@ -255,6 +324,12 @@ void ili9341_init(void)
 
     /* Init LCD */
     ili9341_config_init();
+
+    if (rtos_sema_create(&g_window_sema, 0, 1) != RTK_SUCCESS ||
+        rtos_task_create(NULL, "ili9341_window", window_task, NULL, 1024, WINDOW_TASK_PRIO) != RTK_SUCCESS) {
+        printf("ili9341 window task create failed!\r\n");
+    }
+
     PPE_MaskAllInt();
     PPE_ClearINTPendingBit(PPE_ALL_OVER_INT | PPE_FR_OVER_INT | PPE_LOAD_OVER_INT | PPE_LINE_WL_INT | PPE_SUSP_INAC_INT);
 
@@ -276,29 +351,31 @@ void ili9341_register_callback(ILI9341VBlankCallback *callback, void *data)
     g_data = data;
 }
 
-void ili9341_clean_invalidate_buffer(uint8_t *buffer)
+int ili9341_flush_rects(uint8_t *buffer, const ILI9341Rect *rects, int count)
 {
-    Prepare_PPE(buffer);
+    int i;
 
-    /* Set window to (0, 0, 240, 320)*/
-    u8 data[4];
-    data[0] = 0 >> 8;
-    data[1] = 0 & 0xff;
-    data[2] = (WIDTH - 1) >> 8;
-    data[3] = (WIDTH - 1) & 0xff;
-    info.cmd[0] = 0x2A;
+    /* Nothing to wait for, VBlank only ever comes from the irq */
+    g_rect_cnt = lcd_rect_merge(rects, count, g_rects, ILI9341_MAX_RECTS, WIDTH, HEIGHT);
+    if (g_rect_cnt == 0) {
+        return 0;
+    }
 
-    QSPI_Write(&info, data, 4);
+    /* Only the rows being sent have to reach memory */
+    for (i = 0; i < g_rect_cnt; i++) {
+        DCache_Clean((u32)(buffer + g_rects[i].y1 * STRIDE), (g_rects[i].y2 - g_rects[i].y1 + 1) * STRIDE);
+    }
 
-    data[0] = 0 >> 8;
-    data[1] = 0 & 0xff;
-    data[2] = (HEIGHT - 1) >> 8;
-    data[3] = (HEIGHT - 1) & 0xff;
-    info.cmd[0] = 0x2B;
-    QSPI_Write(&info, data, 4);
+    g_buffer = buffer;
+    g_rect_idx = 0;
+    start_rect(&g_rects[0]);
 
-    info.cmd[0] = 0x2C;
-    QSPI_WriteStart(&info, PPE_MEM_SIZE);
-    PPE_Cmd(ENABLE);
+    return g_rect_cnt;
 }
 
+void ili9341_clean_invalidate_buffer(uint8_t *buffer)
+{
+    ILI9341Rect full = {0, 0, WIDTH - 1, HEIGHT - 1};
+
+    ili9341_flush_rects(buffer, &full, 1);
+}
@@ -2,14 +2,26 @@
 #define _ILI9341_H
 
 #include "ameba_soc.h"
+#include "lcd_rect.h"
 
 typedef struct {
 	void (*VBlank)(void *user_data);
 } ILI9341VBlankCallback;
 
+/* Inclusive screen rectangle */
+typedef LCDRect ILI9341Rect;
+
+/* Rectangles kept after merging, more are folded into their bounding box */
+#define ILI9341_MAX_RECTS	8
+
 void ili9341_init(void);
 void ili9341_get_info(int *width, int *height);
 void ili9341_clean_invalidate_buffer(u8 *buffer);
+/*
+ * Send only the dirty rectangles of a full frame buffer, VBlank fires from the irq after the last one.
+ * Returns 0 if no rectangle is on screen, nothing is sent and VBlank does not fire then.
+ */
+int ili9341_flush_rects(u8 *buffer, const ILI9341Rect *rects, int count);
 
 void ili9341_register_callback(ILI9341VBlankCallback *callback, void *data);
 
@@ -0,0 +1,72 @@
+/*
+ * Copyright (c) 2025 Realtek Semiconductor Corp.
+ * All rights reserved.
+ *
+ * Licensed under the Realtek License, Version 1.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License from Realtek
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "ameba_soc.h"
+#include "lcd_rect.h"
+
+u32 lcd_rect_area(const LCDRect *r)
+{
+    return (u32)(r->x2 - r->x1 + 1) * (r->y2 - r->y1 + 1);
+}
+
+void lcd_rect_union(LCDRect *dst, const LCDRect *src)
+{
+    dst->x1 = MIN(dst->x1, src->x1);
+    dst->y1 = MIN(dst->y1, src->y1);
+    dst->x2 = MAX(dst->x2, src->x2);
+    dst->y2 = MAX(dst->y2, src->y2);
+}
+
+int lcd_rect_merge(const LCDRect *in, int count, LCDRect *out, int max, u16 width, u16 height)
+{
+    int cnt = 0;
+    int merged;
+    int i, j;
+
+    for (i = 0; i < count; i++) {
+        LCDRect r = in[i];
+
+        if (r.x1 > r.x2 || r.y1 > r.y2 || r.x1 >= width || r.y1 >= height) {
+            continue;
+        }
+        r.x2 = MIN(r.x2, width - 1);
+        r.y2 = MIN(r.y2, height - 1);
+
+        if (cnt == max) {
+            lcd_rect_union(&out[cnt - 1], &r);
+        } else {
+            out[cnt++] = r;
+        }
+    }
+
+    do {
+        merged = 0;
+        for (i = 0; i < cnt && !merged; i++) {
+            for (j = i + 1; j < cnt; j++) {
+                LCDRect u = out[i];
+
+                lcd_rect_union(&u, &out[j]);
+                if (lcd_rect_area(&u) <= lcd_rect_area(&out[i]) + lcd_rect_area(&out[j]) + LCD_RECT_MERGE_SLACK) {
+                    out[i] = u;
+                    out[j] = out[--cnt];
+                    merged = 1;
+                    break;
+                }
+            }
+        }
+    } while (merged);
+
+    return cnt;
+}
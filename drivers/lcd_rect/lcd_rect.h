@@ -0,0 +1,25 @@
+#ifndef _LCD_RECT_H
+#define _LCD_RECT_H
+
+#include "ameba_soc.h"
+
+/* Inclusive screen rectangle */
+typedef struct {
+	u16 x1;
+	u16 y1;
+	u16 x2;
+	u16 y2;
+} LCDRect;
+
+/* Pixels that cost as much as setting up one more window */
+#define LCD_RECT_MERGE_SLACK	64
+
+u32 lcd_rect_area(const LCDRect *r);
+void lcd_rect_union(LCDRect *dst, const LCDRect *src);
+/*
+ * Clip to a width x height screen and merge rectangles whose union costs no more than sending them apart.
+ * At most max rectangles are kept, more are folded into the last one. Returns the number written to out.
+ */
+int lcd_rect_merge(const LCDRect *in, int count, LCDRect *out, int max, u16 width, u16 height);
+
+#endif
@@ -31,15 +31,37 @@
 
 #define WIDTH              240
 #define HEIGHT             320
-#define MEM_SIZE           WIDTH * HEIGHT * 2        //rgb565
+#define BPP                2                         //rgb565
+#define STRIDE             (WIDTH * BPP)
+
+/* Sets up the next window of a flush, the tx done irq only chains DMA transfers */
+#define WINDOW_TASK_PRIO   3
 
 static ST7789VVBlankCallback *g_callback = NULL;
 static void *g_data = NULL;
 
 static spi_t spi_lcd;
 
+/* Flush in progress, rows are chained from the tx done irq, windows by window_task */
+static rtos_sema_t g_window_sema = NULL;
+static ST7789VRect g_rects[ST7789V_MAX_RECTS];
+static int g_rect_cnt = 0;
+static int g_rect_idx = 0;
+static u8 *g_buffer = NULL;
+static u8 *g_row = NULL;
+static u32 g_row_bytes = 0;
+static u16 g_rows_left = 0;
+
+/* Tx done fires once the DMA has filled the fifo, A0 must not change before the pixels are out */
+static void LCD_WAIT_IDLE(void)
+{
+    while (spi_busy(&spi_lcd)) {
+    }
+}
+
 static void LCD_WR_REG(u16 data)
 {
+    LCD_WAIT_IDLE();
     GPIO_WriteBit(A0, 0);
     spi_master_write(&spi_lcd, data);
     GPIO_WriteBit(A0, 1);
@@ -50,12 +72,58 @@ static void LCD_WR_DATA8(u8 data)
     spi_master_write(&spi_lcd, data);
 }
 
+static void LCD_SET_WINDOW(u16 x0, u16 y0, u16 x1, u16 y1)
+{
+    LCD_WR_REG(0x2a);
+    LCD_WR_DATA8(x0 >> 8);
+    LCD_WR_DATA8(x0 & 0xff);
+    LCD_WR_DATA8(x1 >> 8);
+    LCD_WR_DATA8(x1 & 0xff);
+    LCD_WR_REG(0x2b);
+    LCD_WR_DATA8(y0 >> 8);
+    LCD_WR_DATA8(y0 & 0xff);
+    LCD_WR_DATA8(y1 >> 8);
+    LCD_WR_DATA8(y1 & 0xff);
+    LCD_WR_REG(0x2c);
+}
+
+static void start_rect(const ST7789VRect *rect)
+{
+    u32 row_bytes = (rect->x2 - rect->x1 + 1) * BPP;
+    u16 rows = rect->y2 - rect->y1 + 1;
+
+    g_row = g_buffer + rect->y1 * STRIDE + rect->x1 * BPP;
+    if (row_bytes == STRIDE) {
+        /* full width rows are contiguous, one transfer covers them all */
+        g_row_bytes = rows * STRIDE;
+        g_rows_left = 0;
+    } else {
+        /* the panel keeps its RAMWR address between transfers */
+        g_row_bytes = row_bytes;
+        g_rows_left = rows - 1;
+    }
+
+    LCD_SET_WINDOW(rect->x1, rect->y1, rect->x2, rect->y2);
+    spi_master_write_stream_dma(&spi_lcd, (char *) g_row, g_row_bytes);
+}
+
 void spi_tx_done_callback(uint32_t pdata, SpiIrq event)
 {
     (void)pdata;
 
     switch (event) {
     case SpiTxIrq:
+        if (g_rows_left) {
+            g_row += STRIDE;
+            g_rows_left--;
+            spi_master_write_stream_dma(&spi_lcd, (char *) g_row, g_row_bytes);
+            break;
+        }
+        if (++g_rect_idx < g_rect_cnt) {
+            /* Setting the window is blocking register writes, not for irq context */
+            rtos_sema_give(g_window_sema);
+            break;
+        }
         if (g_callback) {
             g_callback->VBlank(g_data);
         }
@@ -65,21 +133,14 @@ void spi_tx_done_callback(uint32_t pdata, SpiIrq event)
     }
 }
 
-static void LCD_WR_PIX(u8 *pbuf, u16 x0, u16 y0, u16 x1, u16 y1)
+static void window_task(void *param)
 {
-    LCD_WR_REG(0x2a);
-    LCD_WR_DATA8(x0 >> 8);
-    LCD_WR_DATA8(x0 & 0xff);
-    LCD_WR_DATA8(x1 >> 8);
-    LCD_WR_DATA8(x1 & 0xff);
-    LCD_WR_REG(0x2b);
-    LCD_WR_DATA8(y0 >> 8);
-    LCD_WR_DATA8(y0 & 0xff);
-    LCD_WR_DATA8(y1 >> 8);
-    LCD_WR_DATA8(y1 & 0xff);
-    LCD_WR_REG(0x2c);
+    (void)param;
 
-    spi_master_write_stream_dma(&spi_lcd, (char *) pbuf, (x1 - x0 + 1) * (y1 - y0 + 1) * 2);
+    for (;;) {
+        rtos_sema_take(g_window_sema, RTOS_MAX_TIMEOUT);
+        start_rect(&g_rects[g_rect_idx]);
+    }
 }
 
 static void st7789v_config_init(void)
@@ -178,6 +239,11 @@ void st7789v_init(void)
 
     spi_irq_hook(&spi_lcd, (spi_irq_handler) spi_tx_done_callback, (uint32_t)&spi_lcd);
 
+    if (rtos_sema_create(&g_window_sema, 0, 1) != RTK_SUCCESS ||
+        rtos_task_create(NULL, "st7789v_window", window_task, NULL, 1024, WINDOW_TASK_PRIO) != RTK_SUCCESS) {
+        printf("st7789v window task create failed!\n");
+    }
+
     GPIO_InitTypeDef ResetPin;
     ResetPin.GPIO_Pin = RST;
     ResetPin.GPIO_PuPd = GPIO_PuPd_NOPULL;
@@ -224,9 +290,31 @@ void st7789v_register_callback(ST7789VVBlankCallback *callback, void *data)
     g_data = data;
 }
 
-void st7789v_clean_invalidate_buffer(uint8_t *buffer)
+int st7789v_flush_rects(uint8_t *buffer, const ST7789VRect *rects, int count)
 {
-    DCache_Clean((u32)buffer, MEM_SIZE);
-    LCD_WR_PIX(buffer, 0, 0, WIDTH-1, HEIGHT-1);
+    int i;
+
+    /* Nothing to wait for, VBlank only ever comes from the irq */
+    g_rect_cnt = lcd_rect_merge(rects, count, g_rects, ST7789V_MAX_RECTS, WIDTH, HEIGHT);
+    if (g_rect_cnt == 0) {
+        return 0;
+    }
+
+    /* Only the rows being sent have to reach memory */
+    for (i = 0; i < g_rect_cnt; i++) {
+        DCache_Clean((u32)(buffer + g_rects[i].y1 * STRIDE), (g_rects[i].y2 - g_rects[i].y1 + 1) * STRIDE);
+    }
+
+    g_buffer = buffer;
+    g_rect_idx = 0;
+    start_rect(&g_rects[0]);
+
+    return g_rect_cnt;
 }
 
+void st7789v_clean_invalidate_buffer(uint8_t *buffer)
+{
+    ST7789VRect full = {0, 0, WIDTH - 1, HEIGHT - 1};
+
+    st7789v_flush_rects(buffer, &full, 1);
+}
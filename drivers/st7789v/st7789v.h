@@ -2,14 +2,26 @@
 #define _ST7789V_H
 
 #include "ameba_soc.h"
+#include "lcd_rect.h"
 
 typedef struct {
 	void (*VBlank)(void *user_data);
 } ST7789VVBlankCallback;
 
+/* Inclusive screen rectangle */
+typedef LCDRect ST7789VRect;
+
+/* Rectangles kept after merging, more are folded into their bounding box */
+#define ST7789V_MAX_RECTS	8
+
 void st7789v_init(void);
 void st7789v_get_info(int *width, int *height);
 void st7789v_clean_invalidate_buffer(u8 *buffer);
+/*
+ * Send only the dirty rectangles of a full frame buffer, VBlank fires from the irq after the last one.
+ * Returns 0 if no rectangle is on screen, nothing is sent and VBlank does not fire then.
+ */
+int st7789v_flush_rects(u8 *buffer, const ST7789VRect *rects, int count);
 
 void st7789v_register_callback(ST7789VVBlankCallback *callback, void *data);
 
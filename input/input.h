@@ -17,12 +17,16 @@
 #define AMEBA_UI_INPUT_INPUT_H
 
 #include <stdint.h>
+#include <stdbool.h>
 
 #define INPUT_CAP_TOUCH         (1 << 0)
 #define INPUT_CAP_KEYBOARD      (1 << 1)
 #define INPUT_CAP_MOUSE         (1 << 2)
 #define INPUT_CAP_MULTI_TOUCH   (1 << 3)
 
+// events buffered between the device workers and the UI, power of two.
+#define INPUT_EVENT_QUEUE_SIZE  32
+
 typedef enum {
     INPUT_EVENT_TOUCH,
     INPUT_EVENT_KEY,
@@ -33,7 +37,7 @@ typedef struct {
     uint16_t x;
     uint16_t y;
     uint8_t pressed;        // 1: touch down, 0: touch up
-    uint8_t touch_id;       // Touch point ID (for multi-touch)
+    uint8_t touch_id;       // Touch point ID, stable from press to release (for multi-touch)
 } input_touch_data_t;
 
 typedef struct {
@@ -52,7 +56,7 @@ typedef struct {
 
 typedef struct {
     input_event_type_t type;
-    uint32_t timestamp;
+    uint32_t timestamp;     // system time in ms when the device reported it
     union {
         input_touch_data_t touch;
         input_key_data_t key;
@@ -102,4 +106,12 @@ input_device_t *input_get_device(const char *name);
 input_device_t *input_get_device_by_type(input_dev_type_t type);
 void input_set_global_callback(input_event_callback_t cb);
 
+// every dispatched event is also queued once a consumer enabled the queue. Lock-free with
+// one producer (the enabled device's worker) and one consumer (the UI task), a full queue
+// drops the new event and counts it.
+void input_event_queue_enable(bool enable);
+bool input_event_pop(input_event_t *event);
+uint32_t input_event_pending(void);
+uint32_t input_event_dropped(void);
+
 #endif // AMEBA_UI_INPUT_INPUT_H
\ No newline at end of file
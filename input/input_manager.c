@@ -23,15 +23,47 @@
 #define LOG_TAG "INPUT"
 
 #define MAX_INPUT_DEVICES   10
+#define INPUT_EVENT_QUEUE_MASK  (INPUT_EVENT_QUEUE_SIZE - 1)
 
 static input_device_t *s_devices[MAX_INPUT_DEVICES];
 static int s_device_count = 0;
 static input_event_callback_t s_global_callback = NULL;
 
+// head only moves in the producer, tail only in the consumer
+static input_event_t s_event_queue[INPUT_EVENT_QUEUE_SIZE];
+static volatile uint32_t s_event_head = 0;
+static volatile uint32_t s_event_tail = 0;
+static volatile uint32_t s_event_dropped = 0;
+// off until a consumer attaches, nothing would drain it otherwise
+static volatile bool s_event_queue_enabled = false;
+static volatile bool s_event_overflow = false;
+
 extern input_device_t *input_touch_gt911_init(void);
 extern input_device_t *input_touch_cst328_init(void);
 
+static bool input_event_push(const input_event_t *event) {
+    uint32_t head = s_event_head;
+
+    if (head - s_event_tail >= INPUT_EVENT_QUEUE_SIZE) {
+        s_event_dropped++;
+        return false;
+    }
+
+    s_event_queue[head & INPUT_EVENT_QUEUE_MASK] = *event;
+    // the slot must be written before the consumer can see it
+    __DMB();
+    s_event_head = head + 1;
+
+    return true;
+}
+
 static void input_dispatch_event(input_event_t *event) {
+    // warn once per overflow, the consumer clears it when it catches up
+    if (s_event_queue_enabled && !input_event_push(event) && !s_event_overflow) {
+        s_event_overflow = true;
+        RTK_LOGW(LOG_TAG, "event queue full, dropping events\n");
+    }
+
     if (s_global_callback) {
         s_global_callback(event);
     }
@@ -41,6 +73,11 @@ void input_manager_init(void) {
     RTK_LOGI(LOG_TAG, "Initialize input manager\n");
     memset(s_devices, 0, sizeof(s_devices));
     s_device_count = 0;
+    s_event_head = 0;
+    s_event_tail = 0;
+    s_event_dropped = 0;
+    s_event_queue_enabled = false;
+    s_event_overflow = false;
 
     input_device_t *gt911_dev = input_touch_gt911_init();
     if (gt911_dev) {
@@ -109,3 +146,35 @@ input_device_t *input_get_device_by_type(input_dev_type_t type) {
 void input_set_global_callback(input_event_callback_t cb) {
     s_global_callback = cb;
 }
+
+void input_event_queue_enable(bool enable) {
+    // start from an empty queue, the producer only pushes once it sees enabled
+    s_event_tail = s_event_head;
+    s_event_overflow = false;
+    s_event_queue_enabled = enable;
+}
+
+bool input_event_pop(input_event_t *event) {
+    uint32_t tail = s_event_tail;
+
+    if (tail == s_event_head) {
+        s_event_overflow = false;
+        return false;
+    }
+
+    // read the slot only after seeing the head that published it
+    __DMB();
+    *event = s_event_queue[tail & INPUT_EVENT_QUEUE_MASK];
+    __DMB();
+    s_event_tail = tail + 1;
+
+    return true;
+}
+
+uint32_t input_event_pending(void) {
+    return s_event_head - s_event_tail;
+}
+
+uint32_t input_event_dropped(void) {
+    return s_event_dropped;
+}
@@ -54,18 +54,27 @@
         } \
     } while(0)
 
-#define MSG_Q_SIZE 10
+/* Finger 1, finger count, 0xAB, fingers 2..5 and the 0xAB after the last one */
+#define CST_REPORT_LEN (7 + (TPD_MAX_FINGERS - 1) * 5 + 1)
+#define CST_EXIT_TIMEOUT_MS 100
+/* Finger ids are the high nibble of the first byte of each record */
+#define CST_MAX_TOUCH_ID 16
+
+struct cst328_point {
+    u16 x;
+    u16 y;
+};
 
 struct cst328_data {
     i2c_t client;
     gpio_irq_t gpio_irq;
     rtos_mutex_t lock;
-    rtos_queue_t work_queue;
+    rtos_sema_t irq_sema;
+    rtos_sema_t exit_sema;
     bool initialized;
     bool enabled;
-    u16 x;
-    u16 y;
-    bool is_pressed;
+    u16 pressed_mask;
+    struct cst328_point points[CST_MAX_TOUCH_ID];
 };
 
 static input_device_t cst328_device;
@@ -192,55 +201,64 @@ static int cst328_read_firmware_info(struct cst328_data *ts)
     return 0;
 }
 
+/* Tell the chip the report was read so it can post the next one */
+static void cst328_finish_read(struct cst328_data *ts)
+{
+    u8 i2c_buf[3] = {0xD0, 0x00, 0xAB};
+
+    if (i2c_write(&ts->client, I2C_ADDR, (char *)i2c_buf, 3, 1) < 0) {
+        RTK_LOGE(LOG_TAG, "Send read touch info ending failed\n");
+    }
+}
+
+/* Touch ids are the chip's finger ids, stable while the finger is down */
+static void cst328_report_point(struct cst328_data *ts, u8 id, u8 pressed)
+{
+    if (s_user_cb) {
+        input_event_t event;
+        event.type = INPUT_EVENT_TOUCH;
+        event.timestamp = rtos_time_get_current_system_time_ms();
+        event.data.touch.x = ts->points[id].x;
+        event.data.touch.y = ts->points[id].y;
+        event.data.touch.pressed = pressed;
+        event.data.touch.touch_id = id;
+        s_user_cb(&event);
+    }
+}
+
 static void cst328_process_touch_data(struct cst328_data *ts)
 {
     CHECK_AND_RETURN(ts);
 
-    u8 i2c_buf[8];
-    u8 buf[30] = {0};
+    u8 buf[CST_REPORT_LEN] = {0};
     int ret;
     int cnt;
     int idx;
+    u8 id;
     u8 sw;
+    u16 down = 0;
     u16 input_x = 0;
     u16 input_y = 0;
-    u16 reg;
-    int i2c_len, len_1, len_2;
 
-    rtos_mutex_take(ts->lock, MUTEX_WAIT_TIMEOUT);
-
-    ret = cst328_i2c_read(&ts->client, CST_TP1_REG, buf, 7);
+    /* The whole report in one transfer, however many fingers are down */
+    ret = cst328_i2c_read(&ts->client, CST_TP1_REG, buf, CST_REPORT_LEN);
     if (ret < 0) {
         RTK_LOGW(LOG_TAG, "%s: Read CST_TP1_REG fail\n", __func__);
-        goto err_finish;
+        return;
     }
 
+    cst328_finish_read(ts);
+
     if (buf[6] != 0xAB) {
         RTK_LOGW(LOG_TAG, "Scan data is not valid\n");
-        i2c_buf[0] = 0xD0;
-        i2c_buf[1] = 0x00;
-        i2c_buf[2] = 0xAB;
-        ret = i2c_write(&ts->client, I2C_ADDR, (char *)i2c_buf, 3, 1);
-        if (ret < 0) {
-            RTK_LOGE(LOG_TAG, "Send read touch info ending failed\n");
-        }
-        goto err_finish;
+        return;
     }
 
     cnt = buf[5] & 0x7F;
 
     if (cnt > TPD_MAX_FINGERS) {
         RTK_LOGE(LOG_TAG, "Scan touch exceed max fingers\n");
-        i2c_buf[0] = 0xD0;
-        i2c_buf[1] = 0x00;
-        i2c_buf[2] = 0xAB;
-        ret = i2c_write(&ts->client, I2C_ADDR, (char *)i2c_buf, 3, 1);
-        if (ret < 0) {
-            RTK_LOGE(LOG_TAG, "Send read touch info ending failed\n");
-        }
-        goto err_finish;
-    } else if (cnt == 0) {
-        goto err_finish;
+        return;
     }
 
     if (cnt > 1) {
@@ -248,124 +266,51 @@ static void cst328_process_touch_data(struct cst328_data *ts)
             RTK_LOGD(LOG_TAG, "Scan cnt: %d\n", cnt);
         }
 
-        i2c_len = (cnt - 1) * 5 + 1;
-        len_1 = i2c_len;
-
-        for (idx = 0; idx < i2c_len; idx += 6) {
-            i2c_buf[0] = 0xD0;
-            i2c_buf[1] = 0x07 + idx;
-            reg = (u16)((i2c_buf[0] << 8) | i2c_buf[1]);
-
-            if (CST328_DEBUG) {
-                RTK_LOGD(LOG_TAG, "Scan read touch reg: 0x%x\n", reg);
-            }
-
-            if (len_1 >= 6) {
-                len_2 = 6;
-                len_1 -= 6;
-            } else {
-                len_2 = len_1;
-                len_1 = 0;
-            }
-
-            cst328_i2c_read(&ts->client, reg, i2c_buf, len_2);
-            for (int i = 0; i < len_2; i++) {
-                buf[5 + idx + i] = i2c_buf[i];
-            }
-        }
-        i2c_len += 5;
-
-        if (buf[i2c_len - 1] != 0xAB) {
+        if (buf[7 + (cnt - 1) * 5] != 0xAB) {
             RTK_LOGE(LOG_TAG, "Scan data error!\n");
-            buf[0] = 0xD0;
-            buf[1] = 0x00;
-            buf[2] = 0xAB;
-            ret = i2c_write(&ts->client, I2C_ADDR, (char *)buf, 3, 1);
-            if (ret < 0) {
-                RTK_LOGE(LOG_TAG, "Send read touch info ending failed\n");
-            }
-            goto err_finish;
+            return;
         }
     }
 
-    i2c_buf[0] = 0xD0;
-    i2c_buf[1] = 0x00;
-    i2c_buf[2] = 0xAB;
-    ret = i2c_write(&ts->client, I2C_ADDR, (char *)i2c_buf, 3, 1);
-    if (ret < 0) {
-        RTK_LOGE(LOG_TAG, "Scan send read touch info ending failed\n");
-    }
+    for (idx = 0; idx < cnt; idx++) {
+        /* Finger 1 is at 0xD000, the others follow the count and 0xAB at 0xD007 */
+        u8 *p = idx == 0 ? buf : buf + 7 + (idx - 1) * 5;
 
-    idx = 0;
-    input_x = (u16)((buf[idx + 1] << 4) | ((buf[idx + 3] >> 4) & 0x0F));
-    input_y = (u16)((buf[idx + 2] << 4) | (buf[idx + 3] & 0x0F));
-    sw = (buf[idx] & 0x0F) >> 1;
+        id = p[0] >> 4;
+        sw = (p[0] & 0x0F) >> 1;
+        input_x = (u16)((p[1] << 4) | ((p[3] >> 4) & 0x0F));
+        input_y = (u16)((p[2] << 4) | (p[3] & 0x0F));
 
-    if (CST328_DEBUG) {
-        RTK_LOGD(LOG_TAG, "CST328 Point x:%d, y:%d, sw:%d\n", input_x, input_y, sw);
-    }
-
-    if (sw == 0x03) {
-        bool state_changed = false;
-        if (!ts->is_pressed) {
-            ts->is_pressed = true;
-            state_changed = true;
-        }
-        ts->x = XSIZE - input_x;
-        ts->y = YSIZE - input_y;
-
-        if (s_user_cb) {
-            input_event_t event;
-            event.type = INPUT_EVENT_TOUCH;
-            event.timestamp = 0;
-            event.data.touch.x = ts->x;
-            event.data.touch.y = ts->y;
-            event.data.touch.touch_id = 0;
-
-            if (state_changed) {
-                event.data.touch.pressed = 1;
-                RTK_LOGD(LOG_TAG, "Touch PRESS: (%d, %d)\n", ts->x, ts->y);
-            } else {
-                event.data.touch.pressed = 1;
-                RTK_LOGD(LOG_TAG, "Touch MOVE: (%d, %d)\n", ts->x, ts->y);
-            }
-            s_user_cb(&event);
+        if (CST328_DEBUG) {
+            RTK_LOGD(LOG_TAG, "CST328 Point id:%d x:%d, y:%d, sw:%d\n", id, input_x, input_y, sw);
         }
-    } else {
-        if (ts->is_pressed) {
-            ts->is_pressed = false;
-
-            if (s_user_cb) {
-                input_event_t event;
-                event.type = INPUT_EVENT_TOUCH;
-                event.timestamp = 0;
-                event.data.touch.x = ts->x;
-                event.data.touch.y = ts->y;
-                event.data.touch.pressed = 0;
-                event.data.touch.touch_id = 0;
-
-                s_user_cb(&event);
-                RTK_LOGD(LOG_TAG, "Touch RELEASE: (%d, %d)\n", ts->x, ts->y);
-            }
+
+        /* A lifted finger is released below together with the missing ones */
+        if (sw != 0x03) {
+            continue;
         }
-    }
 
-err_finish:
-    rtos_mutex_give(ts->lock);
-}
+        ts->points[id].x = XSIZE - input_x;
+        ts->points[id].y = YSIZE - input_y;
 
-static int cst328_work_handler(struct cst328_data *ts)
-{
-    void *p_msg = NULL;
+        if (ts->pressed_mask & (1 << id)) {
+            RTK_LOGD(LOG_TAG, "Touch MOVE %d: (%d, %d)\n", id, ts->points[id].x, ts->points[id].y);
+        } else {
+            RTK_LOGD(LOG_TAG, "Touch PRESS %d: (%d, %d)\n", id, ts->points[id].x, ts->points[id].y);
+        }
 
-    if (ts->enabled) {
-        if (RTK_SUCCESS == rtos_queue_receive(ts->work_queue, &p_msg, 20)) {
-            cst328_process_touch_data(ts);
-            return 0;
+        cst328_report_point(ts, id, 1);
+        down |= 1 << id;
+    }
+
+    for (id = 0; id < CST_MAX_TOUCH_ID; id++) {
+        if (ts->pressed_mask & ~down & (1 << id)) {
+            cst328_report_point(ts, id, 0);
+            RTK_LOGD(LOG_TAG, "Touch RELEASE %d: (%d, %d)\n", id, ts->points[id].x, ts->points[id].y);
         }
     }
 
-    return -1;
+    ts->pressed_mask = down;
 }
 
 static void cst328_irq_handler(u32 dev_id, u32 event)
@@ -374,9 +319,8 @@ static void cst328_irq_handler(u32 dev_id, u32 event)
     struct cst328_data *ts = (struct cst328_data *)dev_id;
     CHECK_AND_RETURN(ts);
 
-    if (RTK_SUCCESS != rtos_queue_send(ts->work_queue, ts, 0)) {
-        RTK_LOGW(LOG_TAG, "%s, send queue failed\n", __func__);
-    }
+    /* Binary semaphore, reports arriving while the worker reads collapse into one wake-up */
+    rtos_sema_give(ts->irq_sema);
 }
 
 static void cst328_work(void *param)
@@ -384,16 +328,14 @@ static void cst328_work(void *param)
     struct cst328_data *ts = (struct cst328_data *)param;
     CHECK_AND_RETURN(ts);
 
-    while (ts->initialized) {
+    /* Sleeps until the INT line fires, the irq is off while disabled */
+    while (rtos_sema_take(ts->irq_sema, RTOS_MAX_TIMEOUT) == RTK_SUCCESS && ts->initialized) {
         if (ts->enabled) {
-            if (cst328_work_handler(ts)) {
-                rtos_time_delay_ms(20);
-            }
-        } else {
-            rtos_time_delay_ms(20);
+            cst328_process_touch_data(ts);
         }
     }
 
+    rtos_sema_give(ts->exit_sema);
     rtos_task_delete(NULL);
 }
 
@@ -435,13 +377,14 @@ static void cst328_init_ops(void)
     struct cst328_data *cst328 = (struct cst328_data *) rtos_mem_zmalloc(sizeof(struct cst328_data));
     rtos_mutex_create_static(&cst328->lock);
     rtos_mutex_give(cst328->lock);
-    rtos_queue_create(&cst328->work_queue, MSG_Q_SIZE, sizeof(uint32_t));
+    rtos_sema_create(&cst328->irq_sema, 0, 1);
+    rtos_sema_create(&cst328->exit_sema, 0, 1);
 
     cst328_init_i2c(cst328);
     cst328_init_chip(cst328);
 
     cst328->initialized = true;
-    cst328->is_pressed = false;
+    cst328->pressed_mask = 0;
     cst328_device.priv = cst328;
 
     if (rtos_task_create(NULL, ((const char *)"cst328_work"), cst328_work, cst328, 1024 * 4, 3) != RTK_SUCCESS) {
@@ -455,9 +398,15 @@ static void cst328_deinit_ops(void)
     CHECK_AND_RETURN(cst328);
 
     cst328->initialized = false;
-    rtos_mutex_delete_static(cst328->lock);
-    rtos_queue_delete(cst328->work_queue);
     gpio_irq_deinit(&cst328->gpio_irq);
+
+    /* Wake the worker and let it exit before its data goes away */
+    rtos_sema_give(cst328->irq_sema);
+    rtos_sema_take(cst328->exit_sema, CST_EXIT_TIMEOUT_MS);
+
+    rtos_mutex_delete_static(cst328->lock);
+    rtos_sema_delete(cst328->irq_sema);
+    rtos_sema_delete(cst328->exit_sema);
     rtos_mem_free(cst328);
     cst328_device.priv = NULL;
 }
@@ -507,7 +456,7 @@ input_device_t *input_touch_cst328_init(void)
     snprintf(cst328_device.info.name, sizeof(cst328_device.info.name), "cst328");
     cst328_device.info.type = INPUT_DEV_TOUCH;
     cst328_device.info.state = INPUT_DEV_DISABLED;
-    cst328_device.info.capabilities = INPUT_CAP_TOUCH;
+    cst328_device.info.capabilities = INPUT_CAP_TOUCH | INPUT_CAP_MULTI_TOUCH;
 
     cst328_device.ops = cst328_ops;
     cst328_device.register_callback = cst328_register_callback;
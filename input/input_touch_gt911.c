@@ -84,18 +84,28 @@ static const u8 GT911_CFG_TBL[] =
     0XFF, 0XFF, 0XFF, 0XFF,
 };
 
-#define MSG_Q_SIZE 20
+/* Status byte followed by 8 bytes per point, from GT_GSTID_REG */
+#define GT_REPORT_LEN           (1 + 8 * TPD_MAX_FINGERS)
+#define GT_EXIT_TIMEOUT_MS      100
+/* Track ids the chip hands out, kept while the finger stays down */
+#define GT_MAX_TOUCH_ID         16
 
-/* Device structure */
-struct gt911_data {
+struct gt911_point {
     u16 x;
     u16 y;
+};
+
+/* Device structure */
+struct gt911_data {
+    u16 pressed_mask;
+    struct gt911_point points[GT_MAX_TOUCH_ID];
 
     bool initialized;
     bool enabled;
     gpio_irq_t gpio_irq;
     i2c_t client;
-    rtos_queue_t work_queue;
+    rtos_sema_t irq_sema;
+    rtos_sema_t exit_sema;
     rtos_mutex_t lock;
 };
 
@@ -157,15 +167,15 @@ static int gt911_send_command(i2c_t *client, u8 cmd)
     return gt911_write_reg(client, GT_CTRL_REG, cmd);
 }
 
-static void gt911_raw_callback(u16 x, u16 y, u8 state) {
+static void gt911_raw_callback(u8 id, u16 x, u16 y, u8 state) {
     if (s_user_cb) {
         input_event_t event;
         event.type = INPUT_EVENT_TOUCH;
-        event.timestamp = 0;
+        event.timestamp = rtos_time_get_current_system_time_ms();
         event.data.touch.x = x;
         event.data.touch.y = y;
         event.data.touch.pressed = state;
-        event.data.touch.touch_id = 0;
+        event.data.touch.touch_id = id;
         s_user_cb(&event);
     }
 }
@@ -267,98 +277,75 @@ static int gt911_read_product_info(struct gt911_data *ts)
 static void gt911_process_touch_data(struct gt911_data *ts)
 {
     CHECK_AND_RETURN(ts);
-    u8 read[10] = { 0 };
-    u8 mode = 0;
+    u8 read[GT_REPORT_LEN] = { 0 };
     u8 point_num = 0;
     u8 reset = 0;
+    u16 down = 0;
     int ret = 0;
-    int len = 0;
 
-    rtos_mutex_take(ts->lock, MUTEX_WAIT_TIMEOUT);
-    ret = gt911_read_reg(&ts->client, GT_GSTID_REG, &mode);
+    /* Status and point data in one transfer */
+    ret = gt911_i2c_read(&ts->client, GT_GSTID_REG, read, GT_REPORT_LEN);
 
     if (ret < 0) {
-        RTK_LOGW(LOG_TAG, "%s: Read mode fail. \r\n", __func__);
-        goto err_finish;
+        RTK_LOGW(LOG_TAG, "%s: Slave no response. \r\n", __func__);
+        return;
     }
 
-    RTK_LOGD(LOG_TAG, "%s: mode: %x \r\n", __func__, mode);
-    read[0] = mode;
-
-    if (mode & 0x80) {
-        ret = gt911_write_reg(&ts->client, GT_GSTID_REG, reset); // clear flags
+    RTK_LOGD(LOG_TAG, "%s: mode: %x \r\n", __func__, read[0]);
 
-        if (ret < 0) {
-            RTK_LOGW(LOG_TAG, "%s: Slave no ACK. \r\n", __func__);
-            goto err_finish;
-        }
-    } else {
-        goto err_finish;
+    if (!(read[0] & 0x80)) {
+        return;
     }
 
-    point_num = mode & 0x0F;
+    ret = gt911_write_reg(&ts->client, GT_GSTID_REG, reset); // clear flags
 
-    if (point_num == 0) {
-        goto err_finish;
+    if (ret < 0) {
+        RTK_LOGW(LOG_TAG, "%s: Write reset fail. \r\n", __func__);
     }
 
-    len = gt911_i2c_read(&ts->client, GT_POINT_REG, read + 1, 7);
+    point_num = read[0] & 0x0F;
 
-    if (len < 0) {
-        RTK_LOGW(LOG_TAG, "%s: Slave no response. \r\n", __func__);
-        goto err_finish;
+    if (point_num > TPD_MAX_FINGERS) {
+        return;
     }
 
-    ret = gt911_write_reg(&ts->client, GT_GSTID_REG, reset);
-    if (ret < 0) {
-        RTK_LOGW(LOG_TAG, "%s: Write reset fail. \r\n", __func__);
-        goto err_finish;
-    }
+    /* Every record lists a finger that is down, the ones missing were lifted */
+    for (u8 i = 0; i < point_num; i++) {
+        u8 *p = read + 1 + i * 8;
+        u8 id = p[0];
+        u16 x = (p[1] | (p[2] << 8));
+        u16 y = (p[3] | (p[4] << 8));
 
-err_finish:
-    if (read[0] > 0) {
-        u8 state = len > 0 ? 1 : 0;
-        u16 x = (read[2] | (read[3] << 8));
-        u16 y = (read[4] | (read[5] << 8));
-        if (state) {
+        if (id >= GT_MAX_TOUCH_ID) {
+            continue;
+        }
 #if TRANSFORM_INVERSE_X
-            x = XSIZE - x;
+        x = XSIZE - x;
 #endif
 #if TRANSFORM_INVERSE_Y
-            y = YSIZE - y;
+        y = YSIZE - y;
 #endif
 #if TRANSFORM_EXCHANGE_X_Y
-            ts->x = x;
-            x = y;
-            y = ts->x;
+        u16 t = x;
+        x = y;
+        y = t;
 #endif
-            ts->x = x;
-            ts->y = y;
-        } else {
-            x = ts->x;
-            y = ts->y;
-        }
+        ts->points[id].x = x;
+        ts->points[id].y = y;
+        down |= 1 << id;
 
-        gt911_raw_callback(x, y, state);
-        RTK_LOGD(LOG_TAG, "x:%d y:%d pressure:%d\n", x, y, state);
+        gt911_raw_callback(id, x, y, 1);
+        RTK_LOGD(LOG_TAG, "id:%d x:%d y:%d pressure:1\n", id, x, y);
     }
 
-    rtos_mutex_give(ts->lock);
-}
-
-/* Work queue handler function */
-static int gt911_work_handler(struct gt911_data *ts)
-{
-    void *p_msg = NULL;
-
-    if (ts->enabled) {
-        if (RTK_SUCCESS == rtos_queue_receive(ts->work_queue, &p_msg, 20)) {
-            gt911_process_touch_data(ts);
-            return 0;
+    for (u8 id = 0; id < GT_MAX_TOUCH_ID; id++) {
+        if (ts->pressed_mask & ~down & (1 << id)) {
+            gt911_raw_callback(id, ts->points[id].x, ts->points[id].y, 0);
+            RTK_LOGD(LOG_TAG, "id:%d x:%d y:%d pressure:0\n", id, ts->points[id].x, ts->points[id].y);
         }
     }
 
-    return -1;
+    ts->pressed_mask = down;
 }
 
 /* Interrupt handler function */
@@ -368,10 +355,8 @@ static void gt911_irq_handler(u32 dev_id, u32 event)
     struct gt911_data *ts = (struct gt911_data *)dev_id;
     CHECK_AND_RETURN(ts);
 
-    /* Add work to work queue */
-    if (RTK_SUCCESS != rtos_queue_send(ts->work_queue, ts, 0)) {
-        RTK_LOGW(LOG_TAG, "%s, send queue failed\n", __func__);
-    }
+    /* Wake the worker, edges during a read collapse into one wake-up */
+    rtos_sema_give(ts->irq_sema);
 }
 
 /* Initialize chip */
@@ -395,16 +380,14 @@ static void gt911_work(void *param) {
     struct gt911_data *ts = (struct gt911_data *) param;
     CHECK_AND_RETURN(ts);
 
-    while (ts->initialized) {
+    /* Blocks until the INT line fires, the irq is off while disabled */
+    while (rtos_sema_take(ts->irq_sema, RTOS_MAX_TIMEOUT) == RTK_SUCCESS && ts->initialized) {
         if (ts->enabled) {
-            if (gt911_work_handler(ts)) {
-                rtos_time_delay_ms(20);
-            }
-        } else {
-            rtos_time_delay_ms(20);
+            gt911_process_touch_data(ts);
         }
     }
 
+    rtos_sema_give(ts->exit_sema);
     rtos_task_delete(NULL);
 }
 
@@ -414,7 +397,8 @@ static void gt911_init_ops(void) {
     struct gt911_data *gt911 = (struct gt911_data *) rtos_mem_zmalloc(sizeof(struct gt911_data));
     rtos_mutex_create_static(&gt911->lock);
     rtos_mutex_give(gt911->lock);
-    rtos_queue_create(&gt911->work_queue, MSG_Q_SIZE, sizeof(uint32_t));
+    rtos_sema_create(&gt911->irq_sema, 0, 1);
+    rtos_sema_create(&gt911->exit_sema, 0, 1);
     gt911_init_chip(gt911);
     gt911->initialized = true;
     gt911_device.priv = gt911;
@@ -429,9 +413,15 @@ static void gt911_deinit_ops(void) {
     CHECK_AND_RETURN(gt911);
 
     gt911->initialized = false;
-    rtos_mutex_delete_static(gt911->lock);
-    rtos_queue_delete(gt911->work_queue);
     gpio_irq_deinit(&gt911->gpio_irq);
+
+    /* Let the worker exit before its data is freed */
+    rtos_sema_give(gt911->irq_sema);
+    rtos_sema_take(gt911->exit_sema, GT_EXIT_TIMEOUT_MS);
+
+    rtos_mutex_delete_static(gt911->lock);
+    rtos_sema_delete(gt911->irq_sema);
+    rtos_sema_delete(gt911->exit_sema);
     rtos_mem_free(gt911);
     gt911_device.priv = NULL;
 }
@@ -472,7 +462,7 @@ input_device_t *input_touch_gt911_init(void) {
     snprintf(gt911_device.info.name, sizeof(gt911_device.info.name), "gt911");
     gt911_device.info.type = INPUT_DEV_TOUCH;
     gt911_device.info.state = INPUT_DEV_DISABLED;
-    gt911_device.info.capabilities = INPUT_CAP_TOUCH;
+    gt911_device.info.capabilities = INPUT_CAP_TOUCH | INPUT_CAP_MULTI_TOUCH;
 
     gt911_device.ops = gt911_ops;
     gt911_device.register_callback = gt911_register_callback;